@@ -6,12 +6,16 @@
 #include "mvc/controller/timer/timer.h"
 #include "mvc/controller/rtc/rtc.h"
 #include "mvc/model/game.h"
+#include "mvc/model/perft/perft.h"
+#include "mvc/model/engine/bench.h"
 #include "sprites/Cursor/cursors.xpm"
 #include "sprites/pieces.xpm"
 #include "mvc/controller/controller.h"
 #include <lcom/lcf.h>
 #include <machine/int86.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 /**
  * @file main.c
@@ -42,6 +46,10 @@ extern enum FlowState current_state;
 extern struct Board *board;
 extern struct Game *game;
 extern struct Menu *menu;
+extern struct TTable transposition_table;
+extern bool transposition_table_ready;
+extern struct Book opening_book;
+extern bool opening_book_ready;
 /*
 int rtc_test_date(void) {
     date_time dt;
@@ -152,6 +160,12 @@ int _exit_() {
   if (vg_exit() != 0)
     return 1;
 
+  if (transposition_table_ready)
+    tt_destroy(&transposition_table);
+  if (opening_book_ready)
+    book_close(&opening_book);
+  tb_free();
+
   return 0;
 }
 
@@ -169,6 +183,38 @@ int(proj_main_loop)(int argc, char *argv[]) {
   message msg;
   uint8_t irq_timer, irq_keyboard, irq_mouse , irq_rtc;
 
+  // "lcom_run proj perft ..." benchmarks the move generator without touching any device
+  if (argc >= 1 && strcmp(argv[0], "perft") == 0)
+    return perft_command(argc, argv);
+
+  // "lcom_run proj bench ..." measures the search on a fixed set of positions
+  if (argc >= 1 && strcmp(argv[0], "bench") == 0)
+    return bench_command(argc, argv);
+
+  // "lcom_run proj bitbase <file> [threads]" generates the bitbases of the small endings
+  if (argc >= 1 && strcmp(argv[0], "bitbase") == 0)
+    return bitbase_command(argc, argv);
+
+  // "lcom_run proj hash <MB> book <file> bitbases <file>" sizes the transposition table and picks the opening book and bitbases of the computer player
+  unsigned hash_megabytes = TT_DEFAULT_MB;
+  const char *book_path = BOOK_DEFAULT_PATH;
+  const char *bitbase_path = BITBASE_DEFAULT_PATH;
+  for (int i = 0; i + 1 < argc; i += 2) {
+    if (strcmp(argv[i], "hash") == 0 && atoi(argv[i + 1]) > 0)
+      hash_megabytes = atoi(argv[i + 1]);
+    else if (strcmp(argv[i], "book") == 0)
+      book_path = argv[i + 1];
+    else if (strcmp(argv[i], "bitbases") == 0)
+      bitbase_path = argv[i + 1];
+  }
+  // wrong slider tables would make every move of the game suspect
+  if (init_bitboard_tables() != 0)
+    return 1;
+  init_transposition_table(hash_megabytes);
+  init_opening_book(book_path);
+  if (tb_init(bitbase_path) != 0)
+    printf("could not load the bitbases %s\n", bitbase_path);
+
   if (enable_mouse_report() != 0) {
     return 1;
   }
@@ -227,6 +273,9 @@ int(proj_main_loop)(int argc, char *argv[]) {
                 decrease_player_timer();
                 game_loop(game);
               }
+              // the search comes last, so a long slice never delays the clocks; a game that just ended was freed by game_loop
+              if (current_state == GAME)
+                computer_turn();
             }
           }
 
@@ -8,6 +8,7 @@
 #include "controller.h"
 #include "keyboard/keyboard.h"
 #include "../controller/rtc/rtc.h"
+#include "../../utils/timing.h"
 
 extern uint8_t scancode;
 extern struct scancode_info scan_info;
@@ -22,11 +23,23 @@ extern struct Position *button_position;
 bool can_draw_this = true;
 bool game_alredy_started = false;
 
-struct Board tempBoard;
-
 current_date dt = {0,0,0,0,0,0,0};
 bool isWhiteTurn = true;
 
+uint64_t last_hash = 0;
+
+struct Engine engine;
+struct TTable transposition_table;
+bool transposition_table_ready = false;
+struct Book opening_book;
+bool opening_book_ready = false;
+bool tablebase_adjudication = true; // whether endings the tablebases know are decided without being played out
+uint64_t book_probed_hash = 0; // hash of the last position the book had no move for, so it is not probed again
+int engine_level = 0; // 0: two human players, 1 to ENGINE_LEVELS: the computer plays black at that level
+bool engine_ponder = true; // whether the computer also thinks on the human player's time
+uint64_t slice_nodes = ENGINE_SLICE_MIN_NODES; // nodes the computer searches per timer interrupt, measured as it thinks
+uint64_t pondered_hash = 0; // hash of the last position pondered to the end, so it is not pondered again
+
 
 /**
  * @brief Initializes a new game with the specified time limit for each player.
@@ -39,60 +52,192 @@ bool isWhiteTurn = true;
  */
 void init_game(struct Game *game,int minutes, int seconds) {
   // game->White_player = {};
-  init_board(&game->board);
+  init_position(game);
   init_player(&game->Black_player, false, minutes, seconds);
   init_player(&game->White_player, true, minutes, seconds);
-  game->state = START;
-  game->piece_count = 32;
-  game->isWhiteTurn = true;
 
   index_ = 0;
+
+  if (engine_level > 0) {
+    engine_init(&engine, engine_level, transposition_table_ready ? &transposition_table : NULL);
+    pondered_hash = 0;
+    book_probed_hash = 0;
+    if (transposition_table_ready) {
+      tt_clear(&transposition_table);
+    }
+  }
+}
+
+/**
+ * @brief Allocates the transposition table of the computer player.
+ *
+ * If the table cannot be allocated, a TT_FALLBACK_MB one is tried instead: the search goes on from one slice to the next through the table, and is much weaker without one.
+ *
+ * @param megabytes Size of the table.
+ * @return 0 upon success, 1 if the requested size could not be allocated.
+ */
+int init_transposition_table(unsigned megabytes) {
+  transposition_table_ready = tt_create(&transposition_table, megabytes) == 0;
+  if (transposition_table_ready) {
+    return 0;
+  }
+  printf("could not allocate a %u MB transposition table\n", megabytes);
+  transposition_table_ready = tt_create(&transposition_table, TT_FALLBACK_MB) == 0;
+  if (!transposition_table_ready) {
+    printf("could not allocate a %u MB transposition table either\n", TT_FALLBACK_MB);
+  }
+  return 1;
+}
+
+/**
+ * @brief Opens the opening book of the computer player.
+ *
+ * The computer still plays without a book, searching from the first move.
+ *
+ * @param path Path of the Polyglot .bin file.
+ * @return 0 upon success, 1 otherwise.
+ */
+int init_opening_book(const char *path) {
+  // the choice among the book moves is random, and should differ from one run to the next
+  srand((unsigned) timing_now_us());
+  opening_book_ready = book_open(&opening_book, path) == 0;
+  if (!opening_book_ready) {
+    printf("could not open the opening book %s\n", path);
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Checks if the side to move is played by the computer.
+ *
+ * @return true if a computer opponent was chosen and it is its turn, false otherwise.
+ */
+bool is_computer_turn() {
+  return engine_level > 0 && !game->isWhiteTurn;
+}
+
+/**
+ * @brief Updates the number of nodes searched per slice from the speed of the last slice.
+ *
+ * The speed is smoothed over the slices, so one slice slowed down by a costly position does not halve the next ones.
+ *
+ * @param nodes Nodes searched by the last slice.
+ * @param elapsedUs Time the last slice took, in microseconds.
+ */
+static void update_slice_nodes(uint64_t nodes, uint64_t elapsedUs) {
+  if (elapsedUs == 0) {
+    return;
+  }
+  uint64_t target = nodes * ENGINE_SLICE_US / elapsedUs;
+  slice_nodes = (3 * slice_nodes + target) / 4;
+  if (slice_nodes < ENGINE_SLICE_MIN_NODES) {
+    slice_nodes = ENGINE_SLICE_MIN_NODES;
+  }
+  if (slice_nodes > ENGINE_SLICE_MAX_NODES) {
+    slice_nodes = ENGINE_SLICE_MAX_NODES;
+  }
+}
+
+/**
+ * @brief Lets the computer think for one slice and plays its move once the search is over.
+ *
+ * This function is called on every timer interrupt during a game, after the clocks were served. Each call searches a bounded number of nodes, sized from the measured speed of the search so the slice ends within ENGINE_SLICE_US, well before the next interrupt is due; the time bound stays as a safety net. The keyboard, the mouse and the clocks are thus served while the computer thinks, and its own clock runs meanwhile like a human player's.
+ *
+ * While the position is in the opening book, the computer plays a book move at once, without searching. The time of a move comes from the computer's clock and the move number, see time_budget, bounded by the time of the level. On the human player's turn, the computer ponders: it searches the position the human is thinking about, which fills the transposition table with the replies to the likely moves. A position is pondered to the end once, after which the computer idles until the human moves.
+ */
+void computer_turn() {
+  if (engine_level == 0 || game->state == CHECKMATE || game->state == STALEMATE || game->state == DRAW) {
+    return;
+  }
+  bool pondering = !is_computer_turn();
+  if (pondering && (!engine_ponder || pondered_hash == game->hash)) {
+    return;
+  }
+
+  if (!pondering && opening_book_ready && book_probed_hash != game->hash) {
+    uint16_t move = book_pick(&opening_book, game, (uint32_t) rand());
+    if (move != NO_MOVE) {
+      play_move(game, move);
+      return;
+    }
+    book_probed_hash = game->hash;
+  }
+
+  // the search reads the clock when it starts, so its budget holds for the whole move
+  engine.clock = pondering ? NULL : &game->Black_player.clock;
+
+  uint64_t startUs = timing_now_us();
+  bool done = engine_think(&engine, game, ENGINE_SLICE_US, slice_nodes);
+  if (!done) {
+    update_slice_nodes(engine.nodes - engine.sliceStartNodes, timing_now_us() - startUs);
+  }
+
+  if (done && pondering) {
+    pondered_hash = game->hash;
+  }
+  else if (done && engine.bestMove != NO_MOVE) {
+    play_move(game, engine.bestMove);
+  }
+}
+
+/**
+ * @brief Draws the position reached after a given number of plies.
+ * 
+ * This function takes back the moves made after the requested ply on the game itself, draws the position, then makes the moves again, so the history needs neither a stored board per move nor a copy of the game.
+ * 
+ * @param ply Number of moves, from the start of the game, of the position to draw.
+ */
+void draw_history_position(int ply) {
+  static uint16_t moves[MAX_PLIES];
+  int last = game->undoIndex;
+
+  for (int i = ply; i < last; i++) {
+    moves[i] = game->undoStack[i].move;
+  }
+  while (game->undoIndex > ply) {
+    unmake_move(game);
+  }
+
+  erase_buffer();
+
+  swap_BackgroundBuffer();
+
+  draw_board(&game->board);
+
+  swap_buffers();
+
+  for (int i = ply; i < last; i++) {
+    make_move(game, moves[i]);
+  }
 }
 
 /**
  * @brief Main game loop that updates the game state and checks for game-ending conditions.
  * 
- * This function represents the main game loop. It updates the game state, checks for game-ending conditions such as checkmate or timeout, and handles the transition to the winner screen if necessary.
+ * This function represents the main game loop. It updates the game state, reacts to the game-ending state set by the last move (checkmate, stalemate or draw) or to a timeout, and handles the transition to the winner screen if necessary.
  * 
  * @param game Pointer to the Game structure representing the current game state.
  */
 void game_loop(struct Game *game) {
 
-  bool boardChanged = false;
-
-    for (int i = 0; i < 8; i++) {
-        for (int j = 0; j < 8; j++) {
-            if (tempBoard.squares[i][j].type != game->board.squares[i][j].type) {
-                boardChanged = true;
-                break;
-            }
-        }
-        if (boardChanged) {
-            break;
-        }
-    }
-
-    if (boardChanged) {
-        tempBoard = game->board;
+  // a new position means a move was played: follow it in the history view
+  if (game->hash != last_hash) {
+    last_hash = game->hash;
+    index_ = game->undoIndex;
+  }
 
-        if (index_ < 1024) {
-            boardArray[index_] = game->board;
-            index_++;
-            max_index = index_;
-        } 
-    }
-  int king_count = 0;
-
-  for(int i = 0 ; i < 32 ; i++){
-    if(game->board.pieces[i].type == KING){
-      if(game->board.pieces[i].isWhite)
-        king_count--;
-      else
-        king_count++;
+  // endings the tablebases know are decided at once; the probe is cached, so repeating it every tick is cheap
+  enum TBWdl ending = TB_UNKNOWN;
+  if (tablebase_adjudication && game->piece_count <= TB_MAX_PIECES && game->state != CHECKMATE && game->state != STALEMATE) {
+    ending = tb_probe_wdl(game);
+    if (ending == TB_DRAW) {
+      game->state = DRAW;
     }
   }
 
-  if(king_count == 1){
+  // the state is classified once per move by play_move, so this is only a lookup
+  if (game->state == DRAW || game->state == STALEMATE) {
     current_state = WINNER_SCREEN;
     dt.day = 0;
     dt.month = 0;
@@ -103,10 +248,16 @@ void game_loop(struct Game *game) {
 
     game_alredy_started = false;
 
-    free(game);
     erase_buffer();
-    draw_white_wins();
-  }else if(king_count == -1){
+    swap_BackgroundBuffer();
+    draw_board(&game->board);
+    swap_buffers();
+
+    free(game);
+    return;
+  }
+
+  if (game->state == CHECKMATE || ending == TB_WIN || ending == TB_LOSS) {
     current_state = WINNER_SCREEN;
     dt.day = 0;
     dt.month = 0;
@@ -117,9 +268,15 @@ void game_loop(struct Game *game) {
 
     game_alredy_started = false;
 
+    // the side to move is the one that was mated, or the one the tablebases say wins or loses
+    bool whiteWins = ending == TB_WIN ? game->isWhiteTurn : !game->isWhiteTurn;
     free(game);
     erase_buffer();
-    draw_black_wins();
+    if (whiteWins)
+      draw_white_wins();
+    else
+      draw_black_wins();
+    return;
   }
 
   if(game->White_player.clock.minutes == 0 && game->White_player.clock.seconds == 0 && game->White_player.clock.a_tenth_of_a_second == 0){
@@ -136,6 +293,7 @@ void game_loop(struct Game *game) {
     free(game);
     erase_buffer();
     draw_black_wins();
+    return;
   }
 
   if(game->Black_player.clock.minutes == 0 && game->Black_player.clock.seconds == 0 && game->Black_player.clock.a_tenth_of_a_second == 0){
@@ -265,19 +423,28 @@ void parse_mouse_input() {
 int minutes = 0;
 int seconds = 0;
 
+/**
+ * @brief Draws the game mode menu with the chosen opponent level in its top right corner.
+ */
+static void draw_game_mode_choice() {
+  erase_buffer();
+  draw_game_mode_menu();
+  draw_number(740, 20, engine_level);
+  swap_buffers();
+}
+
 /**
  * @brief Routes the program flow based on the current state and user input.
  * 
  * This function manages the program flow, including transitions between different states (such as MENU, NEW_GAME, INSTRUCTIONS, etc.) and handling user input.
  */
 void router() {
-  struct Board tempBoard ;
   switch (current_state) {
     case MENU:
       switch (key_pressed) {
         case ONE:
           current_state = NEW_GAME;
-          draw_game_mode_menu();
+          draw_game_mode_choice();
           key_pressed = NOKEY;
           break;
         case TWO:
@@ -311,6 +478,19 @@ void router() {
     }
 
     switch (key_pressed) {
+      case ARROW_LEFT:
+      case ARROW_RIGHT:
+        // choose the opponent: 0 for a human, 1 to ENGINE_LEVELS for the computer
+        engine_level += key_pressed == ARROW_RIGHT ? 1 : -1;
+        if (engine_level < 0) {
+          engine_level = 0;
+        }
+        if (engine_level > ENGINE_LEVELS) {
+          engine_level = ENGINE_LEVELS;
+        }
+        key_pressed = NOKEY;
+        draw_game_mode_choice();
+        break;
       case ONE:
         game_alredy_started = true;
 
@@ -491,7 +671,6 @@ void router() {
       {
       case NOKEY:
         
-          tempBoard = game->board;
           erase_buffer();
 
           draw_backBackGround(&game->White_player, &game->Black_player);
@@ -511,16 +690,7 @@ void router() {
           index_ = 0;
         }
 
-
-        tempBoard = boardArray[index_];
-
-        erase_buffer();
-
-        swap_BackgroundBuffer();
-
-        draw_board(&tempBoard);
-
-        swap_buffers();
+        draw_history_position(index_);
 
         can_draw_this = false;
         break;
@@ -528,37 +698,26 @@ void router() {
         
         index_++;
         
-        if((index_-1) >= max_index){
-          index_ = max_index-2;
+        if(index_ >= game->undoIndex){
+          index_ = game->undoIndex;
         }
-         tempBoard = boardArray[index_];
-         erase_buffer();
 
-        swap_BackgroundBuffer();
+        draw_history_position(index_);
 
-        draw_board(&tempBoard);
-
-        swap_buffers();
         can_draw_this = false;
         break;
       case ARROW_DOWN:
         
         index_ = 0;
-         tempBoard = boardArray[index_];
 
-         erase_buffer();
+        draw_history_position(index_);
 
-        swap_BackgroundBuffer();
-
-        draw_board(&tempBoard);
-
-        swap_buffers();
         can_draw_this = false;
 
         break;
       case ARROW_UP:
         key_pressed = NOKEY;
-        index_ = max_index;
+        index_ = game->undoIndex;
         can_draw_this = true;
         router();
         break;
@@ -10,6 +10,10 @@
 #include <lcom/lcf.h>
 #include <stdio.h>
 #include "../model/game.h"
+#include "../model/engine/search.h"
+#include "../model/book/book.h"
+#include "../model/tablebase/tablebase.h"
+#include "../model/tablebase/bitbase.h"
 #include "../view/view.h"
 #include "keyboard/keyboard.h"
 #include "rtc/rtc.h"
@@ -61,19 +65,27 @@ enum FlowState{
 struct Game *game;
 
 /**
- * @brief Array to store game boards.
- */
-struct Board boardArray[1024];
-
-/**
- * @brief Index variable for the boardArray.
+ * @brief Ply of the game shown while browsing the move history.
  */
 int index_;
 
-/**
- * @brief Maximum index value for the boardArray.
- */
-int max_index;
+/** @brief Opening book the computer plays from, unless another one is given on the command line. */
+#define BOOK_DEFAULT_PATH "/home/lcom/labs/g1/proj/src/book.bin"
+
+/** @brief Bitbase file of the small endings, as written by "lcom_run proj bitbase <file>", unless another one is given on the command line. */
+#define BITBASE_DEFAULT_PATH "/home/lcom/labs/g1/proj/src/bitbases.bin"
+
+/** @brief Longest time the computer thinks per timer interrupt, in microseconds (half a frame at 60 Hz). */
+#define ENGINE_SLICE_US 8000
+
+/** @brief Fewest nodes the computer searches per timer interrupt. */
+#define ENGINE_SLICE_MIN_NODES 256
+
+/** @brief Most nodes the computer searches per timer interrupt. */
+#define ENGINE_SLICE_MAX_NODES (1 << 20)
+
+/** @brief Size of the transposition table tried when the requested one cannot be allocated, in megabytes; the sliced search needs one. */
+#define TT_FALLBACK_MB 1
 
 /**
  * @brief Parses keyboard input.
@@ -118,6 +130,41 @@ void init_game(struct Game *game,int minutes, int seconds);
 void game_loop(struct Game * game);
 
 
+/**
+ * @brief Draws the position reached after a given number of plies.
+ *
+ * @param ply Number of moves, from the start of the game, of the position to draw.
+ */
+void draw_history_position(int ply);
+
+/**
+ * @brief Allocates the transposition table of the computer player.
+ *
+ * @param megabytes Size of the table.
+ * @return 0 upon success, 1 otherwise.
+ */
+int init_transposition_table(unsigned megabytes);
+
+/**
+ * @brief Opens the opening book of the computer player.
+ *
+ * @param path Path of the Polyglot .bin file.
+ * @return 0 upon success, 1 otherwise.
+ */
+int init_opening_book(const char *path);
+
+/**
+ * @brief Checks if the side to move is played by the computer.
+ *
+ * @return true if a computer opponent was chosen and it is its turn, false otherwise.
+ */
+bool is_computer_turn();
+
+/**
+ * @brief Lets the computer think for one slice, or ponder on the human player's turn, and plays its move once the search is over.
+ */
+void computer_turn();
+
 /**
  * @brief Decreases the player timer based on the current turn.
  */
@@ -315,6 +315,11 @@ struct mousePosition(get_position_cursor)(struct cursor *cursor) {
 int(in_game_mouse_movement)() {
   switch (_current_state) {
     case INITIAL:
+      if (cursor.position.x >= 200 && cursor.position.y >= 100) {
+        struct Position hovered = {(cursor.position.x - 200) / CELL_SIZE_WIDTH, (cursor.position.y - 100) / CELL_SIZE_HEIGHT};
+        // pieces of the side to move with somewhere to go
+        cursor.type = is_inside_board(&hovered) && game->legalTargets[SQUARE(hovered.x, hovered.y)] && !is_computer_turn() ? HOVERING : DEFAULT;
+      }
 
       if (mouse.lb == BUTTON_PRESSED && mouse.rb != BUTTON_PRESSED && mouse.mb != BUTTON_PRESSED) {
         piece_selected = get_piece_from_click(cursor.position.x, cursor.position.y, CELL_SIZE_HEIGHT, &game->board);
@@ -331,7 +336,7 @@ int(in_game_mouse_movement)() {
           printf("piece selected is white %d\n", piece_selected->isWhite);
           initial_pos.x = piece_selected->position.x;
           initial_pos.y = piece_selected->position.y;
-          if (!piece_selected->isWhite == game->isWhiteTurn) {
+          if (piece_selected->isWhite == game->isWhiteTurn && !is_computer_turn()) {
             _current_state = PIECE_SELECTED;
           }
           //}
@@ -371,16 +376,10 @@ int(in_game_mouse_movement)() {
       final_pos.x = (cursor.position.x - 200) / CELL_SIZE_WIDTH;
       final_pos.y = (cursor.position.y - 100) / CELL_SIZE_HEIGHT;
 
-      if (change_piece_position(piece_selected, &initial_pos, &final_pos, &game->board)) {
-        printf("Piece moved\n");
-
-        changeTurn(game);
-      }
-
-      if (game->board.squares[final_pos.x][final_pos.y].type == PAWN) {
-        if ((game->board.squares[final_pos.x][final_pos.y].isWhite && final_pos.y == 7) ||
-            (!game->board.squares[final_pos.x][final_pos.y].isWhite && final_pos.y == 0)) {
-          promote_pawn_to_queen(&game->board, &game->board.squares[final_pos.x][final_pos.y]);
+      if (is_legal_move(game, &initial_pos, &final_pos)) {
+        advance_piece(piece_selected, &final_pos, &game->board);
+        if (move_piece(game, &initial_pos, &final_pos)) {
+          printf("Piece moved\n");
         }
       }
 
@@ -0,0 +1,415 @@
+/**
+ * @file bitboard.c
+ * @brief Implementation of the bitboard representation of the chess position.
+ *
+ * This file contains the precomputed attack tables and the set operations used to
+ * place, move and look up pieces and to answer attack queries on a position.
+ */
+
+#include "bitboard.h"
+#include "zobrist.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static uint64_t knight_table[64];
+static uint64_t king_table[64];
+static uint64_t pawn_table[2][64];
+static uint64_t between_table[64][64];
+static uint64_t line_table[64][64];
+static bool tables_ready = false;
+
+/**
+ * @brief Castling rights kept when a piece leaves or lands on each square.
+ */
+static uint8_t castling_mask[64];
+
+/**
+ * @brief Builds the attack set of a leaping piece from a list of steps.
+ *
+ * @param sq Square of the piece.
+ * @param steps Array of (dx, dy) pairs.
+ * @param count Number of steps.
+ * @return Attack set.
+ */
+static uint64_t leaper_attacks(int sq, const int steps[][2], int count) {
+  uint64_t attacks = 0;
+  for (int i = 0; i < count; i++) {
+    int x = SQUARE_X(sq) + steps[i][0];
+    int y = SQUARE_Y(sq) + steps[i][1];
+    if (x >= 0 && x < 8 && y >= 0 && y < 8) {
+      attacks |= SQUARE_BIT(SQUARE(x, y));
+    }
+  }
+  return attacks;
+}
+
+/**
+ * @brief Initializes the precomputed attack tables of the non-sliding pieces.
+ *
+ * This function generates the magic tables of the sliding pieces and the Zobrist keys, then fills the knight, king and pawn attack tables, the castling masks and the between/line tables of aligned squares. It only does the work on the first call.
+ *
+ * @return 0 upon success, 1 if the magic tables are wrong, in which case no move can be trusted.
+ */
+int init_bitboard_tables() {
+  static const int knight_steps[8][2] = {{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}};
+  static const int king_steps[8][2] = {{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}};
+  static const int white_pawn_steps[2][2] = {{-1, 1}, {1, 1}};
+  static const int black_pawn_steps[2][2] = {{-1, -1}, {1, -1}};
+
+  if (tables_ready) {
+    return 0;
+  }
+
+  if (init_magic_tables() != 0) {
+    return 1;
+  }
+  init_zobrist_keys();
+
+  for (int sq = 0; sq < 64; sq++) {
+    knight_table[sq] = leaper_attacks(sq, knight_steps, 8);
+    king_table[sq] = leaper_attacks(sq, king_steps, 8);
+    pawn_table[WHITE][sq] = leaper_attacks(sq, white_pawn_steps, 2);
+    pawn_table[BLACK][sq] = leaper_attacks(sq, black_pawn_steps, 2);
+    castling_mask[sq] = CASTLING_ALL;
+  }
+
+  castling_mask[SQUARE(4, 0)] &= ~(CASTLING_WHITE_SHORT | CASTLING_WHITE_LONG);
+  castling_mask[SQUARE(7, 0)] &= ~CASTLING_WHITE_SHORT;
+  castling_mask[SQUARE(0, 0)] &= ~CASTLING_WHITE_LONG;
+  castling_mask[SQUARE(4, 7)] &= ~(CASTLING_BLACK_SHORT | CASTLING_BLACK_LONG);
+  castling_mask[SQUARE(7, 7)] &= ~CASTLING_BLACK_SHORT;
+  castling_mask[SQUARE(0, 7)] &= ~CASTLING_BLACK_LONG;
+
+  for (int a = 0; a < 64; a++) {
+    for (int b = 0; b < 64; b++) {
+      between_table[a][b] = 0;
+      line_table[a][b] = 0;
+      if (a == b) {
+        continue;
+      }
+      if (rook_attacks(a, 0) & SQUARE_BIT(b)) {
+        between_table[a][b] = rook_attacks(a, SQUARE_BIT(b)) & rook_attacks(b, SQUARE_BIT(a));
+        line_table[a][b] = (rook_attacks(a, 0) & rook_attacks(b, 0)) | SQUARE_BIT(a) | SQUARE_BIT(b);
+      }
+      else if (bishop_attacks(a, 0) & SQUARE_BIT(b)) {
+        between_table[a][b] = bishop_attacks(a, SQUARE_BIT(b)) & bishop_attacks(b, SQUARE_BIT(a));
+        line_table[a][b] = (bishop_attacks(a, 0) & bishop_attacks(b, 0)) | SQUARE_BIT(a) | SQUARE_BIT(b);
+      }
+    }
+  }
+
+  tables_ready = true;
+  return 0;
+}
+
+/**
+ * @brief Empties a bitboard position.
+ *
+ * This function removes every piece, gives the turn to white, and clears the castling rights and the en passant square.
+ *
+ * @param bb Pointer to the position to be cleared.
+ */
+void bitboard_clear(struct Bitboard *bb) {
+  memset(bb, 0, sizeof(*bb));
+  bb->isWhiteTurn = true;
+  bb->epSquare = NO_SQUARE;
+}
+
+/**
+ * @brief Puts a piece on an empty square.
+ *
+ * This function sets the square in the piece set, the color set and the occupancy.
+ *
+ * @param bb Pointer to the position.
+ * @param type Type of the piece.
+ * @param isWhite Whether the piece is white.
+ * @param sq Square index.
+ */
+void bitboard_put_piece(struct Bitboard *bb, enum PieceType type, bool isWhite, int sq) {
+  uint64_t bit = SQUARE_BIT(sq);
+  bb->pieces[COLOR(isWhite)][type] |= bit;
+  bb->colors[COLOR(isWhite)] |= bit;
+  bb->occupied |= bit;
+}
+
+/**
+ * @brief Removes whatever piece stands on a square.
+ *
+ * This function clears the square from every set. Removing a rook from its initial square also drops the matching castling right.
+ *
+ * @param bb Pointer to the position.
+ * @param sq Square index.
+ */
+void bitboard_remove_piece(struct Bitboard *bb, int sq) {
+  uint64_t keep = ~SQUARE_BIT(sq);
+  for (int color = WHITE; color <= BLACK; color++) {
+    for (int type = PAWN; type <= KING; type++) {
+      bb->pieces[color][type] &= keep;
+    }
+    bb->colors[color] &= keep;
+  }
+  bb->occupied &= keep;
+  bb->castling &= castling_mask[sq];
+}
+
+/**
+ * @brief Moves the piece standing on a square to an empty square.
+ *
+ * This function relocates the piece in its sets, updates the castling rights for both squares and, after a pawn double push, records the en passant square if an enemy pawn can capture on it (so that equal positions always hash alike).
+ *
+ * @param bb Pointer to the position.
+ * @param from Square the piece leaves.
+ * @param to Square the piece arrives at.
+ */
+void bitboard_move_piece(struct Bitboard *bb, int from, int to) {
+  enum PieceType type;
+  bool isWhite;
+
+  bb->epSquare = NO_SQUARE;
+  if (!bitboard_piece_at(bb, from, &type, &isWhite)) {
+    return;
+  }
+
+  uint64_t fromTo = SQUARE_BIT(from) | SQUARE_BIT(to);
+  bb->pieces[COLOR(isWhite)][type] ^= fromTo;
+  bb->colors[COLOR(isWhite)] ^= fromTo;
+  bb->occupied ^= fromTo;
+  bb->castling &= castling_mask[from] & castling_mask[to];
+
+  if (type == PAWN && abs(to - from) == 16 && (pawn_attacks(isWhite, (from + to) / 2) & bb->pieces[COLOR(!isWhite)][PAWN])) {
+    bb->epSquare = (from + to) / 2;
+  }
+}
+
+/**
+ * @brief Looks up the piece standing on a square.
+ *
+ * This function tests the square against the color sets and then against the piece sets of that color.
+ *
+ * @param bb Pointer to the position.
+ * @param sq Square index.
+ * @param type Filled with the type of the piece, or EMPTY.
+ * @param isWhite Filled with the color of the piece (may be NULL).
+ * @return true if the square is occupied, false otherwise.
+ */
+bool bitboard_piece_at(const struct Bitboard *bb, int sq, enum PieceType *type, bool *isWhite) {
+  uint64_t bit = SQUARE_BIT(sq);
+  *type = EMPTY;
+
+  if (!(bb->occupied & bit)) {
+    return false;
+  }
+
+  int color = (bb->colors[WHITE] & bit) ? WHITE : BLACK;
+  for (int t = PAWN; t <= KING; t++) {
+    if (bb->pieces[color][t] & bit) {
+      *type = (enum PieceType) t;
+      break;
+    }
+  }
+  if (isWhite != NULL) {
+    *isWhite = color == WHITE;
+  }
+  return true;
+}
+
+/**
+ * @brief Returns the squares attacked by a knight.
+ *
+ * @param sq Square of the knight.
+ * @return Attack set.
+ */
+uint64_t knight_attacks(int sq) {
+  return knight_table[sq];
+}
+
+/**
+ * @brief Returns the squares attacked by a king.
+ *
+ * @param sq Square of the king.
+ * @return Attack set.
+ */
+uint64_t king_attacks(int sq) {
+  return king_table[sq];
+}
+
+/**
+ * @brief Returns the squares attacked (diagonally) by a pawn.
+ *
+ * @param isWhite Whether the pawn is white.
+ * @param sq Square of the pawn.
+ * @return Attack set.
+ */
+uint64_t pawn_attacks(bool isWhite, int sq) {
+  return pawn_table[COLOR(isWhite)][sq];
+}
+
+/**
+ * @brief Returns the squares strictly between two aligned squares.
+ *
+ * @param a First square.
+ * @param b Second square.
+ * @return The squares between a and b, or 0 if they are not on a common line.
+ */
+uint64_t between_squares(int a, int b) {
+  return between_table[a][b];
+}
+
+/**
+ * @brief Returns the whole line (rank, file or diagonal) through two aligned squares.
+ *
+ * @param a First square.
+ * @param b Second square.
+ * @return The full line through a and b, or 0 if they are not on a common line.
+ */
+uint64_t line_through(int a, int b) {
+  return line_table[a][b];
+}
+
+/**
+ * @brief Returns the squares a piece attacks from a square.
+ *
+ * @param type Type of the piece.
+ * @param isWhite Whether the piece is white (only relevant for pawns).
+ * @param sq Square of the piece.
+ * @param occupied Occupied squares that block sliding pieces.
+ * @return Attack set.
+ */
+uint64_t piece_attacks(enum PieceType type, bool isWhite, int sq, uint64_t occupied) {
+  switch (type) {
+    case PAWN:
+      return pawn_attacks(isWhite, sq);
+    case KNIGHT:
+      return knight_attacks(sq);
+    case BISHOP:
+      return bishop_attacks(sq, occupied);
+    case ROOK:
+      return rook_attacks(sq, occupied);
+    case QUEEN:
+      return queen_attacks(sq, occupied);
+    case KING:
+      return king_attacks(sq);
+    default:
+      return 0;
+  }
+}
+
+/**
+ * @brief Returns every piece, of both colors, that attacks a square.
+ *
+ * This function looks at the square from the point of view of each piece type: a white pawn attacks the square if a black pawn standing there would attack the white pawn, and so on.
+ *
+ * @param bb Pointer to the position.
+ * @param sq Target square.
+ * @param occupied Occupancy used for the sliding pieces.
+ * @return Set of the attacking pieces.
+ */
+uint64_t attackers_to(const struct Bitboard *bb, int sq, uint64_t occupied) {
+  uint64_t rooks = bb->pieces[WHITE][ROOK] | bb->pieces[BLACK][ROOK] | bb->pieces[WHITE][QUEEN] | bb->pieces[BLACK][QUEEN];
+  uint64_t bishops = bb->pieces[WHITE][BISHOP] | bb->pieces[BLACK][BISHOP] | bb->pieces[WHITE][QUEEN] | bb->pieces[BLACK][QUEEN];
+
+  return (pawn_attacks(false, sq) & bb->pieces[WHITE][PAWN]) |
+         (pawn_attacks(true, sq) & bb->pieces[BLACK][PAWN]) |
+         (knight_attacks(sq) & (bb->pieces[WHITE][KNIGHT] | bb->pieces[BLACK][KNIGHT])) |
+         (king_attacks(sq) & (bb->pieces[WHITE][KING] | bb->pieces[BLACK][KING])) |
+         (rook_attacks(sq, occupied) & rooks) |
+         (bishop_attacks(sq, occupied) & bishops);
+}
+
+/**
+ * @brief Checks if a square is attacked by the pieces of one color.
+ *
+ * This function tries the cheap leaper tables first and only computes the sliding rays when the side has sliding pieces.
+ *
+ * @param bb Pointer to the position.
+ * @param sq Target square.
+ * @param byWhite Whether the attacking side is white.
+ * @return true if the square is attacked, false otherwise.
+ */
+bool is_square_attacked(const struct Bitboard *bb, int sq, bool byWhite) {
+  const uint64_t *them = bb->pieces[COLOR(byWhite)];
+
+  if ((pawn_attacks(!byWhite, sq) & them[PAWN]) || (knight_attacks(sq) & them[KNIGHT]) ||
+      (king_attacks(sq) & them[KING])) {
+    return true;
+  }
+
+  uint64_t rooks = them[ROOK] | them[QUEEN];
+  uint64_t bishops = them[BISHOP] | them[QUEEN];
+
+  return (rooks && (rook_attacks(sq, bb->occupied) & rooks)) ||
+         (bishops && (bishop_attacks(sq, bb->occupied) & bishops));
+}
+
+/**
+ * @brief Returns every square attacked by the pieces of one color.
+ *
+ * This function shifts the whole pawn set at once and adds the table attacks of the other pieces one by one.
+ *
+ * @param bb Pointer to the position.
+ * @param isWhite Whether the attacking side is white.
+ * @param occupied Occupancy used for the sliding pieces.
+ * @return Attack set.
+ */
+uint64_t attacks_by_color(const struct Bitboard *bb, bool isWhite, uint64_t occupied) {
+  const uint64_t *us = bb->pieces[COLOR(isWhite)];
+  uint64_t pawns = us[PAWN];
+  uint64_t attacks = isWhite ? ((pawns & ~FILE_A) << 7) | ((pawns & ~FILE_H) << 9)
+                             : ((pawns & ~FILE_A) >> 9) | ((pawns & ~FILE_H) >> 7);
+  uint64_t knights = us[KNIGHT];
+  uint64_t bishops = us[BISHOP] | us[QUEEN];
+  uint64_t rooks = us[ROOK] | us[QUEEN];
+
+  while (knights) {
+    attacks |= knight_attacks(bitboard_pop_lsb(&knights));
+  }
+  while (bishops) {
+    attacks |= bishop_attacks(bitboard_pop_lsb(&bishops), occupied);
+  }
+  while (rooks) {
+    attacks |= rook_attacks(bitboard_pop_lsb(&rooks), occupied);
+  }
+  if (us[KING]) {
+    attacks |= king_attacks(bitboard_lsb(us[KING]));
+  }
+  return attacks;
+}
+
+/**
+ * @brief Rebuilds the attack maps, the checkers and the pins of a position.
+ *
+ * This function computes the attack set of each color with the enemy king removed from the occupancy, so that a king stepping back along a checking ray is still seen as attacked. A piece is pinned when it is the only piece between its king and an enemy slider that would see the king on an empty board.
+ *
+ * @param bb Pointer to the position.
+ */
+void update_attack_maps(struct Bitboard *bb) {
+  struct AttackInfo *info = &bb->info;
+
+  for (int color = WHITE; color <= BLACK; color++) {
+    uint64_t king = bb->pieces[color][KING];
+    const uint64_t *them = bb->pieces[!color];
+
+    info->attacks[!color] = attacks_by_color(bb, color == BLACK, bb->occupied & ~king);
+    info->pinned[color] = 0;
+    info->pinners[!color] = 0;
+    if (king == 0) {
+      continue;
+    }
+
+    int ksq = bitboard_lsb(king);
+    uint64_t snipers = (rook_attacks(ksq, 0) & (them[ROOK] | them[QUEEN])) |
+                       (bishop_attacks(ksq, 0) & (them[BISHOP] | them[QUEEN]));
+    while (snipers) {
+      int sniper = bitboard_pop_lsb(&snipers);
+      uint64_t blockers = between_table[ksq][sniper] & bb->occupied;
+      if (blockers && !(blockers & (blockers - 1)) && (blockers & bb->colors[color])) {
+        info->pinned[color] |= blockers;
+        info->pinners[!color] |= SQUARE_BIT(sniper);
+      }
+    }
+  }
+
+  uint64_t king = bb->pieces[COLOR(bb->isWhiteTurn)][KING];
+  info->checkers = king ? attackers_to(bb, bitboard_lsb(king), bb->occupied) & bb->colors[COLOR(!bb->isWhiteTurn)] : 0;
+}
@@ -0,0 +1,257 @@
+/**
+ * @file bitboard.h
+ * @brief Header file containing the bitboard representation of the chess position.
+ *
+ * A bitboard is a 64-bit set where bit (y * 8 + x) stands for the square (x, y) of the board.
+ * The position keeps one set per color and piece type, plus the side to move and the
+ * castling and en passant state, so that board queries become set operations.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../enum.h"
+#include "magic.h"
+
+/** @brief Index of the square with coordinates (x, y). */
+#define SQUARE(x, y) ((y) * 8 + (x))
+
+/** @brief x coordinate (file) of a square index. */
+#define SQUARE_X(sq) ((sq) & 7)
+
+/** @brief y coordinate (rank) of a square index. */
+#define SQUARE_Y(sq) ((sq) >> 3)
+
+/** @brief Bitboard with only the given square set. */
+#define SQUARE_BIT(sq) ((uint64_t) 1 << (sq))
+
+/** @brief Value used when there is no square (e.g. no en passant square). */
+#define NO_SQUARE -1
+
+/** @brief Color index of a piece, as used by the bitboard arrays. */
+#define COLOR(isWhite) ((isWhite) ? WHITE : BLACK)
+
+#define CASTLING_WHITE_SHORT 0x01 /**< @brief White may still castle king side */
+#define CASTLING_WHITE_LONG 0x02  /**< @brief White may still castle queen side */
+#define CASTLING_BLACK_SHORT 0x04 /**< @brief Black may still castle king side */
+#define CASTLING_BLACK_LONG 0x08  /**< @brief Black may still castle queen side */
+#define CASTLING_ALL 0x0F         /**< @brief All castling rights */
+
+#define RANK_1 0x00000000000000FFULL /**< @brief Squares with y == 0 */
+#define RANK_2 0x000000000000FF00ULL /**< @brief Squares with y == 1 */
+#define RANK_3 0x0000000000FF0000ULL /**< @brief Squares with y == 2 */
+#define RANK_6 0x0000FF0000000000ULL /**< @brief Squares with y == 5 */
+#define RANK_7 0x00FF000000000000ULL /**< @brief Squares with y == 6 */
+#define RANK_8 0xFF00000000000000ULL /**< @brief Squares with y == 7 */
+#define FILE_A 0x0101010101010101ULL /**< @brief Squares with x == 0 */
+#define FILE_H 0x8080808080808080ULL /**< @brief Squares with x == 7 */
+#define DARK_SQUARES 0xAA55AA55AA55AA55ULL /**< @brief Squares with x + y even (a1 is dark) */
+
+/**
+ * @brief Structure representing the attack state of a position, rebuilt by update_attack_maps().
+ */
+struct AttackInfo {
+  uint64_t attacks[2];  /**< squares attacked per color, seeing through the enemy king */
+  uint64_t checkers;    /**< enemy pieces giving check to the side to move */
+  uint64_t pinned[2];   /**< pieces of each color pinned to their own king */
+  uint64_t pinners[2];  /**< sliders of each color pinning an enemy piece */
+};
+
+/**
+ * @brief Structure representing a chess position as a set of bitboards.
+ */
+struct Bitboard {
+  uint64_t pieces[2][6]; /**< occupancy per color and piece type (PAWN to KING) */
+  uint64_t colors[2];    /**< occupancy per color */
+  uint64_t occupied;     /**< occupancy of both colors */
+  bool isWhiteTurn;      /**< whether it is white's turn */
+  uint8_t castling;      /**< castling rights (CASTLING_* flags) */
+  int8_t epSquare;       /**< square a pawn can capture en passant into, or NO_SQUARE */
+  struct AttackInfo info; /**< attack maps, checkers and pins of the position */
+};
+
+/**
+ * @brief Counts the squares in a bitboard.
+ *
+ * @param bb The bitboard.
+ * @return Number of bits set.
+ */
+static inline int bitboard_count(uint64_t bb) {
+  return __builtin_popcountll(bb);
+}
+
+/**
+ * @brief Returns the lowest square of a non-empty bitboard.
+ *
+ * @param bb The bitboard, must not be empty.
+ * @return Index of the least significant bit set.
+ */
+static inline int bitboard_lsb(uint64_t bb) {
+  return __builtin_ctzll(bb);
+}
+
+/**
+ * @brief Removes and returns the lowest square of a non-empty bitboard.
+ *
+ * @param bb Pointer to the bitboard, must not be empty.
+ * @return Index of the square removed.
+ */
+static inline int bitboard_pop_lsb(uint64_t *bb) {
+  int sq = __builtin_ctzll(*bb);
+  *bb &= *bb - 1;
+  return sq;
+}
+
+/**
+ * @brief Initializes the precomputed attack tables of the non-sliding pieces.
+ *
+ * Also generates the magic tables of the sliding pieces and the Zobrist keys. Safe to call more than once; the
+ * tables are only built the first time.
+ *
+ * @return 0 upon success, 1 if the magic tables disagree with the ray walk.
+ */
+int init_bitboard_tables();
+
+/**
+ * @brief Empties a bitboard position.
+ *
+ * @param bb Pointer to the position to be cleared.
+ */
+void bitboard_clear(struct Bitboard *bb);
+
+/**
+ * @brief Puts a piece on an empty square.
+ *
+ * @param bb Pointer to the position.
+ * @param type Type of the piece.
+ * @param isWhite Whether the piece is white.
+ * @param sq Square index.
+ */
+void bitboard_put_piece(struct Bitboard *bb, enum PieceType type, bool isWhite, int sq);
+
+/**
+ * @brief Removes whatever piece stands on a square.
+ *
+ * @param bb Pointer to the position.
+ * @param sq Square index.
+ */
+void bitboard_remove_piece(struct Bitboard *bb, int sq);
+
+/**
+ * @brief Moves the piece standing on a square to an empty square.
+ *
+ * Like the other editing functions, it leaves the attack state alone; call update_attack_maps()
+ * once the position is complete. Castling rights are dropped when a king or rook leaves its initial square, and the en passant
+ * square is set after a pawn double push that an enemy pawn can capture.
+ *
+ * @param bb Pointer to the position.
+ * @param from Square the piece leaves.
+ * @param to Square the piece arrives at.
+ */
+void bitboard_move_piece(struct Bitboard *bb, int from, int to);
+
+/**
+ * @brief Looks up the piece standing on a square.
+ *
+ * @param bb Pointer to the position.
+ * @param sq Square index.
+ * @param type Filled with the type of the piece, or EMPTY.
+ * @param isWhite Filled with the color of the piece (may be NULL).
+ * @return true if the square is occupied, false otherwise.
+ */
+bool bitboard_piece_at(const struct Bitboard *bb, int sq, enum PieceType *type, bool *isWhite);
+
+/**
+ * @brief Returns the squares attacked by a knight.
+ *
+ * @param sq Square of the knight.
+ * @return Attack set.
+ */
+uint64_t knight_attacks(int sq);
+
+/**
+ * @brief Returns the squares attacked by a king.
+ *
+ * @param sq Square of the king.
+ * @return Attack set.
+ */
+uint64_t king_attacks(int sq);
+
+/**
+ * @brief Returns the squares attacked (diagonally) by a pawn.
+ *
+ * @param isWhite Whether the pawn is white.
+ * @param sq Square of the pawn.
+ * @return Attack set.
+ */
+uint64_t pawn_attacks(bool isWhite, int sq);
+
+/**
+ * @brief Returns the squares strictly between two aligned squares.
+ *
+ * @param a First square.
+ * @param b Second square.
+ * @return The squares between a and b, or 0 if they are not on a common line.
+ */
+uint64_t between_squares(int a, int b);
+
+/**
+ * @brief Returns the whole line (rank, file or diagonal) through two aligned squares.
+ *
+ * @param a First square.
+ * @param b Second square.
+ * @return The full line through a and b, or 0 if they are not on a common line.
+ */
+uint64_t line_through(int a, int b);
+
+/**
+ * @brief Returns the squares a piece attacks from a square.
+ *
+ * @param type Type of the piece.
+ * @param isWhite Whether the piece is white (only relevant for pawns).
+ * @param sq Square of the piece.
+ * @param occupied Occupied squares that block sliding pieces.
+ * @return Attack set.
+ */
+uint64_t piece_attacks(enum PieceType type, bool isWhite, int sq, uint64_t occupied);
+
+/**
+ * @brief Returns every piece, of both colors, that attacks a square.
+ *
+ * @param bb Pointer to the position.
+ * @param sq Target square.
+ * @param occupied Occupancy used for the sliding pieces.
+ * @return Set of the attacking pieces.
+ */
+uint64_t attackers_to(const struct Bitboard *bb, int sq, uint64_t occupied);
+
+/**
+ * @brief Checks if a square is attacked by the pieces of one color.
+ *
+ * @param bb Pointer to the position.
+ * @param sq Target square.
+ * @param byWhite Whether the attacking side is white.
+ * @return true if the square is attacked, false otherwise.
+ */
+bool is_square_attacked(const struct Bitboard *bb, int sq, bool byWhite);
+
+/**
+ * @brief Returns every square attacked by the pieces of one color.
+ *
+ * @param bb Pointer to the position.
+ * @param isWhite Whether the attacking side is white.
+ * @param occupied Occupancy used for the sliding pieces.
+ * @return Attack set.
+ */
+uint64_t attacks_by_color(const struct Bitboard *bb, bool isWhite, uint64_t occupied);
+
+/**
+ * @brief Rebuilds the attack maps, the checkers and the pins of a position.
+ *
+ * Must be called after the position has been edited and the side to move set.
+ *
+ * @param bb Pointer to the position.
+ */
+void update_attack_maps(struct Bitboard *bb);
@@ -0,0 +1,221 @@
+/**
+ * @file magic.c
+ * @brief Implementation of the magic bitboard attack tables of the sliding pieces.
+ *
+ * This file generates, at startup, the rook and bishop attack tables. For every square it
+ * enumerates all subsets of the relevant occupancy, computes their attack sets by walking the
+ * rays square by square, and searches a magic multiplier that sends every subset to a slot
+ * holding the right attack set ("fancy" magics, one table slice per square).
+ */
+
+#include "magic.h"
+#include "bitboard.h"
+
+#include <stdio.h>
+
+struct Magic rook_magics[64];
+struct Magic bishop_magics[64];
+
+static uint64_t rook_table[0x19000];  /**< 102400 rook attack sets shared by all squares */
+static uint64_t bishop_table[0x1480]; /**< 5248 bishop attack sets shared by all squares */
+static bool magics_ready = false;
+
+static const int rook_directions[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+static const int bishop_directions[4][2] = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+
+/**
+ * @brief State of the pseudo-random generator used to search magics.
+ */
+static uint64_t random_state;
+
+/**
+ * @brief Returns the next 64-bit pseudo-random number (xorshift64*).
+ *
+ * @return The random number.
+ */
+static uint64_t random64() {
+  random_state ^= random_state >> 12;
+  random_state ^= random_state << 25;
+  random_state ^= random_state >> 27;
+  return random_state * 2685821657736338717ULL;
+}
+
+/**
+ * @brief Returns a random number with few bits set, which makes a good magic candidate.
+ *
+ * @return The random number.
+ */
+static uint64_t sparse_random64() {
+  return random64() & random64() & random64();
+}
+
+/**
+ * @brief Builds the attack set of a sliding piece by walking its rays square by square.
+ *
+ * This is the reference the tables are generated from and checked against.
+ *
+ * @param sq Square of the piece.
+ * @param occupied Occupied squares that stop the rays.
+ * @param directions Array of (dx, dy) ray directions.
+ * @return Attack set, including the first blocker of each ray.
+ */
+static uint64_t ray_attacks(int sq, uint64_t occupied, const int directions[4][2]) {
+  uint64_t attacks = 0;
+  for (int i = 0; i < 4; i++) {
+    int x = SQUARE_X(sq) + directions[i][0];
+    int y = SQUARE_Y(sq) + directions[i][1];
+    while (x >= 0 && x < 8 && y >= 0 && y < 8) {
+      attacks |= SQUARE_BIT(SQUARE(x, y));
+      if (occupied & SQUARE_BIT(SQUARE(x, y))) {
+        break;
+      }
+      x += directions[i][0];
+      y += directions[i][1];
+    }
+  }
+  return attacks;
+}
+
+/**
+ * @brief Returns the squares whose occupancy can change a slider's attack set.
+ *
+ * The last square of each ray is left out, since it is attacked whether it is occupied or not.
+ *
+ * @param sq Square of the piece.
+ * @param directions Array of (dx, dy) ray directions.
+ * @return Relevant occupancy mask.
+ */
+static uint64_t relevant_mask(int sq, const int directions[4][2]) {
+  uint64_t mask = 0;
+  for (int i = 0; i < 4; i++) {
+    int x = SQUARE_X(sq) + directions[i][0];
+    int y = SQUARE_Y(sq) + directions[i][1];
+    while (x + directions[i][0] >= 0 && x + directions[i][0] < 8 &&
+           y + directions[i][1] >= 0 && y + directions[i][1] < 8) {
+      mask |= SQUARE_BIT(SQUARE(x, y));
+      x += directions[i][0];
+      y += directions[i][1];
+    }
+  }
+  return mask;
+}
+
+/**
+ * @brief Generates the lookup data and the attack table of one sliding piece type.
+ *
+ * This function enumerates every subset of each square's relevant mask (Carry-Rippler trick), and keeps drawing sparse random multipliers until one maps all subsets without a destructive collision. A per-attempt stamp avoids clearing the table slice between attempts.
+ *
+ * @param magics Array of 64 lookup entries to fill.
+ * @param table Attack table shared by the 64 squares.
+ * @param directions Array of (dx, dy) ray directions of the piece.
+ */
+static void init_piece_magics(struct Magic magics[64], uint64_t *table, const int directions[4][2]) {
+  static uint64_t occupancy[4096];
+  static uint64_t reference[4096];
+#ifndef USE_PEXT
+  static const uint64_t seeds[8] = {728, 10316, 55013, 32803, 12281, 15100, 16645, 255};
+  static int stamp[4096];
+  static int attempt = 0;
+#endif
+  uint64_t *next = table;
+
+  for (int sq = 0; sq < 64; sq++) {
+    struct Magic *m = &magics[sq];
+    int size = 0;
+    uint64_t subset = 0;
+
+    m->mask = relevant_mask(sq, directions);
+    m->shift = 64 - bitboard_count(m->mask);
+    m->attacks = next;
+
+    do {
+      occupancy[size] = subset;
+      reference[size] = ray_attacks(sq, subset, directions);
+      size++;
+      subset = (subset - m->mask) & m->mask;
+    } while (subset);
+    next += size;
+
+#ifdef USE_PEXT
+    m->magic = 0;
+    for (int i = 0; i < size; i++) {
+      m->attacks[magic_index(m, occupancy[i])] = reference[i];
+    }
+#else
+    random_state = seeds[SQUARE_Y(sq)];
+    int i;
+    do {
+      do {
+        m->magic = sparse_random64();
+      } while (bitboard_count((m->magic * m->mask) >> 56) < 6);
+
+      attempt++;
+      for (i = 0; i < size; i++) {
+        unsigned index = magic_index(m, occupancy[i]);
+        if (stamp[index] < attempt) {
+          stamp[index] = attempt;
+          m->attacks[index] = reference[i];
+        }
+        else if (m->attacks[index] != reference[i]) {
+          break;
+        }
+      }
+    } while (i < size);
+#endif
+  }
+}
+
+/**
+ * @brief Generates the rook and bishop attack tables.
+ *
+ * This function builds both tables the first time it is called and, unless NDEBUG is defined, verifies them against the ray walk before they are used.
+ *
+ * @return 0 upon success, 1 if the generated tables disagree with the ray walk.
+ */
+int init_magic_tables() {
+  if (magics_ready) {
+    return 0;
+  }
+
+  init_piece_magics(rook_magics, rook_table, rook_directions);
+  init_piece_magics(bishop_magics, bishop_table, bishop_directions);
+  magics_ready = true;
+
+#ifndef NDEBUG
+  if (magic_self_check(64) != 0) {
+    printf("magic tables disagree with the ray walk\n");
+    magics_ready = false;
+    return 1;
+  }
+#endif
+
+  return 0;
+}
+
+/**
+ * @brief Compares table lookups against a square-by-square ray walk.
+ *
+ * This function draws random occupancies of varying density for every square and checks that the rook, bishop and queen lookups return exactly the attack sets found by walking the rays.
+ *
+ * @param samples Number of random occupancies tried per square and piece type.
+ * @return 0 if every lookup matches, 1 otherwise.
+ */
+int magic_self_check(int samples) {
+  random_state = 0x9E3779B97F4A7C15ULL;
+
+  for (int sq = 0; sq < 64; sq++) {
+    for (int i = 0; i < samples; i++) {
+      uint64_t occupied = (i & 1) ? sparse_random64() : random64() & random64();
+
+      uint64_t rook = ray_attacks(sq, occupied, rook_directions);
+      uint64_t bishop = ray_attacks(sq, occupied, bishop_directions);
+
+      if (rook_attacks(sq, occupied) != rook || bishop_attacks(sq, occupied) != bishop ||
+          queen_attacks(sq, occupied) != (rook | bishop)) {
+        printf("magic mismatch on square %d\n", sq);
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
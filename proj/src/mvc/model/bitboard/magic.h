@@ -0,0 +1,97 @@
+/**
+ * @file magic.h
+ * @brief Header file containing the magic bitboard attack tables of the sliding pieces.
+ *
+ * The attack set of a rook or bishop only depends on the occupancy of the squares on its rays.
+ * Those relevant squares are hashed into a table index with one multiply and one shift (or a
+ * single PEXT instruction on x86-64 hosts with BMI2), so a slider's full attack set is one lookup.
+ * The tables are generated at startup by init_magic_tables().
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(__x86_64__) && defined(__BMI2__)
+#  include <immintrin.h>
+#  define USE_PEXT /**< @brief Index the tables with PEXT instead of magic multiplication */
+#endif
+
+/**
+ * @brief Structure representing the lookup data of one square for one sliding piece type.
+ */
+struct Magic {
+  uint64_t mask;      /**< relevant occupancy squares (the rays without their last square) */
+  uint64_t magic;     /**< magic multiplier that maps the relevant occupancy to an index */
+  uint64_t *attacks;  /**< start of this square's slice of the attack table */
+  unsigned shift;     /**< 64 minus the number of relevant squares */
+};
+
+extern struct Magic rook_magics[64];   /**< @brief Rook lookup data per square */
+extern struct Magic bishop_magics[64]; /**< @brief Bishop lookup data per square */
+
+/**
+ * @brief Maps an occupancy to an index in a square's attack table.
+ *
+ * @param m Pointer to the lookup data of the square.
+ * @param occupied Occupied squares of the board.
+ * @return Index in m->attacks.
+ */
+static inline unsigned magic_index(const struct Magic *m, uint64_t occupied) {
+#ifdef USE_PEXT
+  return (unsigned) _pext_u64(occupied, m->mask);
+#else
+  return (unsigned) (((occupied & m->mask) * m->magic) >> m->shift);
+#endif
+}
+
+/**
+ * @brief Returns the squares attacked by a rook for a given occupancy.
+ *
+ * @param sq Square of the rook.
+ * @param occupied Occupied squares that block the rays.
+ * @return Attack set, including the first blocker of each ray.
+ */
+static inline uint64_t rook_attacks(int sq, uint64_t occupied) {
+  return rook_magics[sq].attacks[magic_index(&rook_magics[sq], occupied)];
+}
+
+/**
+ * @brief Returns the squares attacked by a bishop for a given occupancy.
+ *
+ * @param sq Square of the bishop.
+ * @param occupied Occupied squares that block the rays.
+ * @return Attack set, including the first blocker of each ray.
+ */
+static inline uint64_t bishop_attacks(int sq, uint64_t occupied) {
+  return bishop_magics[sq].attacks[magic_index(&bishop_magics[sq], occupied)];
+}
+
+/**
+ * @brief Returns the squares attacked by a queen for a given occupancy.
+ *
+ * @param sq Square of the queen.
+ * @param occupied Occupied squares that block the rays.
+ * @return Attack set, including the first blocker of each ray.
+ */
+static inline uint64_t queen_attacks(int sq, uint64_t occupied) {
+  return rook_attacks(sq, occupied) | bishop_attacks(sq, occupied);
+}
+
+/**
+ * @brief Generates the rook and bishop attack tables.
+ *
+ * Safe to call more than once; the tables are only built the first time.
+ *
+ * @return 0 upon success, 1 if the generated tables disagree with the ray walk.
+ */
+int init_magic_tables();
+
+/**
+ * @brief Compares table lookups against a square-by-square ray walk.
+ *
+ * @param samples Number of random occupancies tried per square and piece type.
+ * @return 0 if every lookup matches, 1 otherwise.
+ */
+int magic_self_check(int samples);
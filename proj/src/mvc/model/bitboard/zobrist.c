@@ -0,0 +1,120 @@
+/**
+ * @file zobrist.c
+ * @brief Implementation of the Zobrist keys used to hash chess positions.
+ *
+ * This file generates the keys with a fixed-seed xorshift64* generator and computes full
+ * position hashes; the incremental updates are done by make_move.
+ */
+
+#include "zobrist.h"
+
+uint64_t zobrist_pieces[2][6][64];
+uint64_t zobrist_castling[16];
+uint64_t zobrist_ep[8];
+uint64_t zobrist_side;
+
+static bool keys_ready = false;
+
+/**
+ * @brief Returns the next key (xorshift64*).
+ *
+ * @param state Pointer to the generator state.
+ * @return The random number.
+ */
+static uint64_t next_key(uint64_t *state) {
+  *state ^= *state >> 12;
+  *state ^= *state << 25;
+  *state ^= *state >> 27;
+  return *state * 2685821657736338717ULL;
+}
+
+/**
+ * @brief Generates the Zobrist keys.
+ *
+ * This function fills the key tables on its first call. The castling keys are built from one key per right, so that the key of a set of rights is the XOR of the keys of its rights.
+ */
+void init_zobrist_keys() {
+  uint64_t state = 1070372;
+  uint64_t rights[4];
+
+  if (keys_ready) {
+    return;
+  }
+
+  for (int color = WHITE; color <= BLACK; color++) {
+    for (int type = PAWN; type <= KING; type++) {
+      for (int sq = 0; sq < 64; sq++) {
+        zobrist_pieces[color][type][sq] = next_key(&state);
+      }
+    }
+  }
+
+  for (int i = 0; i < 4; i++) {
+    rights[i] = next_key(&state);
+  }
+  for (int set = 0; set < 16; set++) {
+    zobrist_castling[set] = 0;
+    for (int i = 0; i < 4; i++) {
+      if (set & (1 << i)) {
+        zobrist_castling[set] ^= rights[i];
+      }
+    }
+  }
+
+  for (int file = 0; file < 8; file++) {
+    zobrist_ep[file] = next_key(&state);
+  }
+  zobrist_side = next_key(&state);
+
+  keys_ready = true;
+}
+
+/**
+ * @brief Computes the hash of a position from scratch.
+ *
+ * This function XORs the keys of every piece, of the castling rights, of the en passant file (if any) and of the side to move.
+ *
+ * @param bb Pointer to the position.
+ * @return Zobrist hash of the position.
+ */
+uint64_t zobrist_hash(const struct Bitboard *bb) {
+  uint64_t hash = zobrist_castling[bb->castling];
+
+  for (int color = WHITE; color <= BLACK; color++) {
+    for (int type = PAWN; type <= KING; type++) {
+      uint64_t pieces = bb->pieces[color][type];
+      while (pieces) {
+        hash ^= zobrist_pieces[color][type][bitboard_pop_lsb(&pieces)];
+      }
+    }
+  }
+
+  if (bb->epSquare != NO_SQUARE) {
+    hash ^= zobrist_ep[SQUARE_X(bb->epSquare)];
+  }
+  if (!bb->isWhiteTurn) {
+    hash ^= zobrist_side;
+  }
+  return hash;
+}
+
+/**
+ * @brief Computes the pawn hash of a position from scratch.
+ *
+ * This function XORs the piece keys of the pawns only, so positions with the same pawns on the same squares share the hash
+ * whatever the other pieces, the castling rights or the side to move.
+ *
+ * @param bb Pointer to the position.
+ * @return Pawn hash of the position.
+ */
+uint64_t zobrist_pawn_hash(const struct Bitboard *bb) {
+  uint64_t hash = 0;
+
+  for (int color = WHITE; color <= BLACK; color++) {
+    uint64_t pawns = bb->pieces[color][PAWN];
+    while (pawns) {
+      hash ^= zobrist_pieces[color][PAWN][bitboard_pop_lsb(&pawns)];
+    }
+  }
+  return hash;
+}
@@ -0,0 +1,44 @@
+/**
+ * @file zobrist.h
+ * @brief Header file containing the Zobrist keys used to hash chess positions.
+ *
+ * The hash of a position is the XOR of one random 64-bit key per (color, piece type, square)
+ * of every piece, plus keys for the castling rights, the en passant file and the side to move.
+ * Since XOR is its own inverse, a move updates the hash by XOR-ing the keys of what it changes.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "bitboard.h"
+
+extern uint64_t zobrist_pieces[2][6][64]; /**< @brief Key per color, piece type and square */
+extern uint64_t zobrist_castling[16];     /**< @brief Key per set of castling rights */
+extern uint64_t zobrist_ep[8];            /**< @brief Key per en passant file */
+extern uint64_t zobrist_side;             /**< @brief Key XOR-ed in when black is to move */
+
+/**
+ * @brief Generates the Zobrist keys.
+ *
+ * Safe to call more than once; the keys are only generated the first time, always from the
+ * same seed, so hashes are stable between runs.
+ */
+void init_zobrist_keys();
+
+/**
+ * @brief Computes the hash of a position from scratch.
+ *
+ * @param bb Pointer to the position.
+ * @return Zobrist hash of the position.
+ */
+uint64_t zobrist_hash(const struct Bitboard *bb);
+
+/**
+ * @brief Computes the pawn hash of a position from scratch: the hash of its pawns alone.
+ *
+ * @param bb Pointer to the position.
+ * @return Pawn hash of the position.
+ */
+uint64_t zobrist_pawn_hash(const struct Bitboard *bb);
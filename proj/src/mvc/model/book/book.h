@@ -0,0 +1,86 @@
+/**
+ * @file book.h
+ * @brief Header file containing the reader of Polyglot opening books.
+ *
+ * A Polyglot book is a file of 16-byte big-endian entries (position key, move, weight, learn
+ * data) sorted by key. The key is Polyglot's own Zobrist hash, not the one of the game, so it
+ * is computed apart from the position. The file is mapped into memory rather than read, so
+ * opening a large book costs nothing until its pages are touched, and a probe is a binary
+ * search that allocates nothing.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../../../utils/mapped_file.h"
+#include "../game.h"
+
+/** @brief Size of an entry in the file, in bytes. */
+#define BOOK_ENTRY_SIZE 16
+
+/** @brief Most moves a probe returns for one position. */
+#define BOOK_MAX_MOVES 32
+
+/**
+ * @brief Structure representing an opened book.
+ */
+struct Book {
+  struct MappedFile file; /**< the file, made of entries of BOOK_ENTRY_SIZE bytes */
+  size_t count;           /**< number of entries */
+};
+
+/**
+ * @brief Structure representing a move of the book for a position.
+ */
+struct BookMove {
+  uint16_t move;   /**< encoded move, as played by make_move */
+  uint16_t weight; /**< weight of the move; a move is picked with a probability proportional to it */
+};
+
+/**
+ * @brief Opens a book.
+ *
+ * @param book Pointer to the book to be set up.
+ * @param path Path of the .bin file.
+ * @return 0 upon success, 1 if the file cannot be read or is not made of whole entries.
+ */
+int book_open(struct Book *book, const char *path);
+
+/**
+ * @brief Closes a book.
+ *
+ * @param book Pointer to the book.
+ */
+void book_close(struct Book *book);
+
+/**
+ * @brief Computes the Polyglot key of the current position of a game.
+ *
+ * @param game Pointer to the game.
+ * @return The key under which books store the position.
+ */
+uint64_t book_key(const struct Game *game);
+
+/**
+ * @brief Looks up the moves of the book for the current position of a game.
+ *
+ * @param book Pointer to the book.
+ * @param game Pointer to the game.
+ * @param moves Filled with the legal moves of the book, in the order of the file.
+ * @param max Size of the moves array.
+ * @return Number of moves written.
+ */
+int book_probe(const struct Book *book, const struct Game *game, struct BookMove *moves, int max);
+
+/**
+ * @brief Picks a move of the book for the current position of a game.
+ *
+ * @param book Pointer to the book.
+ * @param game Pointer to the game.
+ * @param random Random number the choice is drawn from.
+ * @return A move of the book, chosen with a probability proportional to its weight, or NO_MOVE if the book has none.
+ */
+uint16_t book_pick(const struct Book *book, const struct Game *game, uint32_t random);
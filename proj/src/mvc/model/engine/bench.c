@@ -0,0 +1,266 @@
+/**
+ * @file bench.c
+ * @brief Implementation of the search benchmark.
+ *
+ * Every position is searched by a fresh engine with an emptied transposition table, so the runs
+ * do not depend on each other and two runs with the same options search the same tree.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+#include "bench.h"
+#include "smp.h"
+#include "../fen/fen.h"
+#include "../../../utils/timing.h"
+
+/** @brief Positions of the benchmark: the opening, a busy middlegame, an endgame and tactical positions. */
+static const char *const bench_positions[] = {
+  FEN_START,
+  "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+  "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+  "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+  "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+  "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+};
+
+/** @brief Number of benchmark positions. */
+#define BENCH_POSITIONS (sizeof(bench_positions) / sizeof(bench_positions[0]))
+
+/**
+ * @brief Structure associating a command line switch with the search option it turns off.
+ */
+struct BenchSwitch {
+  const char *name; /**< command line argument */
+  size_t offset;    /**< offset of the option in struct SearchOptions */
+};
+
+/** @brief Switches accepted by bench_command. */
+static const struct BenchSwitch bench_switches[] = {
+  {"no-hash-move", offsetof(struct SearchOptions, hashMove)},
+  {"no-mvv-lva", offsetof(struct SearchOptions, mvvLva)},
+  {"no-killers", offsetof(struct SearchOptions, killers)},
+  {"no-history", offsetof(struct SearchOptions, history)},
+  {"no-null-move", offsetof(struct SearchOptions, nullMove)},
+  {"no-lmr", offsetof(struct SearchOptions, lmr)},
+  {"no-pvs", offsetof(struct SearchOptions, pvs)},
+  {"no-see", offsetof(struct SearchOptions, see)},
+  {"no-pawn-table", offsetof(struct SearchOptions, pawnTable)},
+  {"no-tablebases", offsetof(struct SearchOptions, tablebases)},
+};
+
+/** @brief Game the benchmark searches, too large for the stack. */
+static struct Game benchGame;
+
+/** @brief Engine of the benchmark, too large for the stack. */
+static struct Engine benchEngine;
+
+/**
+ * @brief Searches the benchmark positions and prints the nodes and time to each depth.
+ *
+ * This function prints one line per position with its best move and score, then, per depth, the nodes and time summed over
+ * the positions and the effective branching factor, the ratio between the nodes of consecutive depths, and last the hit rate
+ * of the pawn tables.
+ *
+ * @param options Search techniques to use.
+ * @param depth Depth every position is searched to.
+ * @param hashMegabytes Size of the transposition table, cleared before each position; 0 to search without one.
+ * @return 0 upon success, 1 if the transposition table could not be allocated.
+ */
+int bench_run(const struct SearchOptions *options, int depth, unsigned hashMegabytes) {
+  static uint64_t nodes[MAX_SEARCH_PLY + 1];
+  static uint64_t elapsed[MAX_SEARCH_PLY + 1];
+  struct TTable table;
+  uint64_t pawnProbes = 0;
+  uint64_t pawnHits = 0;
+  uint64_t start = timing_now_us();
+
+  if (depth < 1) {
+    depth = 1;
+  }
+  if (depth > MAX_SEARCH_PLY) {
+    depth = MAX_SEARCH_PLY;
+  }
+  if (hashMegabytes > 0 && tt_create(&table, hashMegabytes) != 0) {
+    printf("bench: could not allocate %u MB of transposition table\n", hashMegabytes);
+    return 1;
+  }
+  memset(nodes, 0, sizeof(nodes));
+  memset(elapsed, 0, sizeof(elapsed));
+
+  for (size_t i = 0; i < BENCH_POSITIONS; i++) {
+    game_from_fen(&benchGame, bench_positions[i]);
+    if (hashMegabytes > 0) {
+      tt_clear(&table);
+    }
+    engine_init(&benchEngine, ENGINE_LEVELS, hashMegabytes > 0 ? &table : NULL);
+    benchEngine.options = *options;
+    benchEngine.limits.depth = depth;
+    benchEngine.limits.nodes = UINT64_MAX;
+    benchEngine.limits.timeUs = UINT64_MAX / 2;
+
+    uint16_t move = engine_best_move(&benchEngine, &benchGame);
+    char text[6];
+    move_to_string(move, text);
+    printf("position %d: %s score %d depth %d, %llu nodes\n", (int) i + 1, text, benchEngine.bestScore, benchEngine.completedDepth,
+           (unsigned long long) benchEngine.nodes);
+    pawnProbes += benchEngine.pawns.probes;
+    pawnHits += benchEngine.pawns.hits;
+
+    // a position may end early on a forced mate: its last count stands for the deeper depths
+    for (int d = 1; d <= depth; d++) {
+      int completed = d <= benchEngine.completedDepth ? d : benchEngine.completedDepth;
+      if (completed > 0) {
+        nodes[d] += benchEngine.depthNodes[completed];
+        elapsed[d] += benchEngine.depthUs[completed];
+      }
+    }
+  }
+
+  for (int d = 1; d <= depth; d++) {
+    printf("depth %2d: %12llu nodes %8llu ms", d, (unsigned long long) nodes[d], (unsigned long long) (elapsed[d] / 1000));
+    if (d > 1 && nodes[d - 1] > 0) {
+      uint64_t ratio = nodes[d] * 100 / nodes[d - 1];
+      printf("  ebf %llu.%02llu", (unsigned long long) (ratio / 100), (unsigned long long) (ratio % 100));
+    }
+    printf("\n");
+  }
+  uint64_t total = timing_now_us() - start;
+  printf("bench: %llu nodes, %llu ms, %llu nps\n", (unsigned long long) nodes[depth], (unsigned long long) (total / 1000),
+         (unsigned long long) timing_per_second(nodes[depth], elapsed[depth]));
+  if (pawnProbes > 0) {
+    printf("pawn table: %llu probes, %llu%% hits\n", (unsigned long long) pawnProbes, (unsigned long long) (pawnHits * 100 / pawnProbes));
+  }
+
+  if (hashMegabytes > 0) {
+    tt_destroy(&table);
+  }
+  return 0;
+}
+
+/**
+ * @brief Prints how the parallel search of the benchmark positions scales with the number of threads.
+ *
+ * This function searches every position to the depth with 1, 2, 4, ... threads up to the maximum, emptying the table before
+ * each position, and prints the total time to reach the depth, the nodes of all the threads, the nodes per second, and both
+ * speedups over one thread. Helpers search nodes the main thread would have searched too, so the nodes per second speedup is
+ * an upper bound on the time-to-depth speedup.
+ *
+ * @param depth Depth every position is searched to.
+ * @param maxThreads Largest number of threads to run with.
+ * @param hashMegabytes Size of the shared transposition table, cleared before each position.
+ * @return 0 upon success, 1 if the transposition table could not be allocated.
+ */
+int bench_scaling(int depth, int maxThreads, unsigned hashMegabytes) {
+  struct TTable table;
+  uint64_t baseTime = 0;
+  uint64_t baseRate = 0;
+
+  if (tt_create(&table, hashMegabytes) != 0) {
+    printf("bench: could not allocate %u MB of transposition table\n", hashMegabytes);
+    return 1;
+  }
+
+  printf("bench depth %d, hash %u MB\n", depth, hashMegabytes);
+  printf("%8s %14s %10s %14s %10s %10s\n", "threads", "nodes", "ms", "nps", "time x", "nps x");
+  for (int threads = 1;; threads *= 2) {
+    if (threads > maxThreads) {
+      threads = maxThreads;
+    }
+
+    uint64_t nodes = 0;
+    uint64_t elapsed = 0;
+    for (size_t i = 0; i < BENCH_POSITIONS; i++) {
+      game_from_fen(&benchGame, bench_positions[i]);
+      tt_clear(&table);
+      engine_init(&benchEngine, ENGINE_LEVELS, &table);
+      benchEngine.limits.depth = depth;
+      benchEngine.limits.nodes = UINT64_MAX;
+      benchEngine.limits.timeUs = UINT64_MAX / 2;
+
+      uint64_t positionNodes;
+      uint64_t start = timing_now_us();
+      smp_best_move(&benchEngine, &benchGame, threads, &positionNodes);
+      elapsed += timing_now_us() - start;
+      nodes += positionNodes;
+    }
+
+    uint64_t rate = timing_per_second(nodes, elapsed);
+    if (threads == 1) {
+      baseTime = elapsed;
+      baseRate = rate;
+    }
+    printf("%8d %14llu %10llu %14llu %9.2fx %9.2fx\n", threads, (unsigned long long) nodes, (unsigned long long) elapsed / 1000,
+           (unsigned long long) rate, elapsed ? (double) baseTime / elapsed : 0.0, baseRate ? (double) rate / baseRate : 0.0);
+    if (threads == maxThreads) {
+      break;
+    }
+  }
+
+  tt_destroy(&table);
+  return 0;
+}
+
+/**
+ * @brief Runs the benchmark from command line arguments.
+ *
+ * @param argc Number of arguments, the first being "bench".
+ * @param argv The arguments.
+ * @return 0 upon success, 1 otherwise.
+ */
+int bench_command(int argc, char *argv[]) {
+  struct SearchOptions options = search_default_options;
+  unsigned hashMegabytes = TT_DEFAULT_MB;
+  int depth = BENCH_DEFAULT_DEPTH;
+
+  if (init_bitboard_tables() != 0) {
+    return 1;
+  }
+
+  if (argc >= 2 && strcmp(argv[1], "threads") == 0) {
+    depth = argc > 2 ? atoi(argv[2]) : BENCH_DEFAULT_DEPTH + 2;
+    int maxThreads = argc > 3 ? atoi(argv[3]) : 1;
+#ifdef __linux__
+    if (argc <= 3) {
+      maxThreads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    }
+#endif
+    if (argc > 4 && atoi(argv[4]) > 0) {
+      hashMegabytes = (unsigned) atoi(argv[4]);
+    }
+    if (maxThreads < 1) {
+      maxThreads = 1;
+    }
+    if (maxThreads > SMP_MAX_THREADS) {
+      maxThreads = SMP_MAX_THREADS;
+    }
+    return bench_scaling(depth > 0 ? depth : BENCH_DEFAULT_DEPTH, maxThreads, hashMegabytes);
+  }
+
+  for (int arg = 1; arg < argc; arg++) {
+    size_t i = 0;
+    while (i < sizeof(bench_switches) / sizeof(bench_switches[0]) && strcmp(argv[arg], bench_switches[i].name) != 0) {
+      i++;
+    }
+
+    if (i < sizeof(bench_switches) / sizeof(bench_switches[0])) {
+      *(bool *) ((char *) &options + bench_switches[i].offset) = false;
+    }
+    else if (strcmp(argv[arg], "no-tt") == 0) {
+      hashMegabytes = 0;
+    }
+    else if (atoi(argv[arg]) > 0) {
+      depth = atoi(argv[arg]);
+    }
+    else {
+      printf("bench: unknown argument \"%s\"\n", argv[arg]);
+      return 1;
+    }
+  }
+  return bench_run(&options, depth, hashMegabytes);
+}
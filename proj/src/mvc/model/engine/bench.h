@@ -0,0 +1,48 @@
+/**
+ * @file bench.h
+ * @brief Header file containing the search benchmark used to measure the search techniques.
+ *
+ * The benchmark searches a fixed set of positions to a fixed depth and reports, per depth, the
+ * nodes and the time the search took to get there. Running it with a technique turned off shows
+ * how much of the tree that technique saves. On the Linux host build it can also compare the
+ * parallel search with 1 to N threads.
+ */
+
+#pragma once
+
+#include "search.h"
+
+/** @brief Default depth of the benchmark. */
+#define BENCH_DEFAULT_DEPTH 7
+
+/**
+ * @brief Searches the benchmark positions and prints the nodes and time to each depth.
+ *
+ * @param options Search techniques to use.
+ * @param depth Depth every position is searched to.
+ * @param hashMegabytes Size of the transposition table, cleared before each position; 0 to search without one.
+ * @return 0 upon success, 1 if the transposition table could not be allocated.
+ */
+int bench_run(const struct SearchOptions *options, int depth, unsigned hashMegabytes);
+
+/**
+ * @brief Prints how the parallel search of the benchmark positions scales with the number of threads.
+ *
+ * @param depth Depth every position is searched to.
+ * @param maxThreads Largest number of threads to run with.
+ * @param hashMegabytes Size of the shared transposition table, cleared before each position.
+ * @return 0 upon success, 1 if the transposition table could not be allocated.
+ */
+int bench_scaling(int depth, int maxThreads, unsigned hashMegabytes);
+
+/**
+ * @brief Runs the benchmark from command line arguments.
+ *
+ * "bench [depth] [no-hash-move] [no-mvv-lva] [no-killers] [no-history] [no-null-move] [no-lmr] [no-pvs] [no-see] [no-pawn-table] [no-tablebases] [no-tt]"
+ * turns the named techniques off; "bench threads [depth] [maxThreads] [hashMB]" runs bench_scaling.
+ *
+ * @param argc Number of arguments, the first being "bench".
+ * @param argv The arguments.
+ * @return 0 upon success, 1 otherwise.
+ */
+int bench_command(int argc, char *argv[]);
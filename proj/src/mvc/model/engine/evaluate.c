@@ -0,0 +1,178 @@
+/**
+ * @file evaluate.c
+ * @brief Implementation of the static evaluation of positions used by the search.
+ *
+ * The piece-square tables reward central knights and bishops, pawns that advance, rooks on the
+ * seventh rank and, in the midgame, a king sheltered behind its pawns; in the endgame the king
+ * is drawn to the center and the pawns towards promotion instead.
+ */
+
+#include "evaluate.h"
+
+const int piece_values_mg[6] = {100, 500, 320, 330, 900, 0};
+const int piece_values_eg[6] = {120, 520, 300, 320, 920, 0};
+const int phase_weights[6] = {0, 2, 1, 1, 4, 0};
+
+/** @brief Midgame bonus of a pawn on each square. */
+static const int8_t pawn_mg[64] = {
+    0,   0,   0,   0,   0,   0,   0,   0,
+   50,  50,  50,  50,  50,  50,  50,  50,
+   10,  10,  20,  30,  30,  20,  10,  10,
+    5,   5,  10,  25,  25,  10,   5,   5,
+    0,   0,   0,  20,  20,   0,   0,   0,
+    5,  -5, -10,   0,   0, -10,  -5,   5,
+    5,  10,  10, -20, -20,  10,  10,   5,
+    0,   0,   0,   0,   0,   0,   0,   0,
+};
+
+/** @brief Endgame bonus of a pawn on each square. */
+static const int8_t pawn_eg[64] = {
+    0,   0,   0,   0,   0,   0,   0,   0,
+   80,  80,  80,  80,  80,  80,  80,  80,
+   50,  50,  50,  50,  50,  50,  50,  50,
+   30,  30,  30,  30,  30,  30,  30,  30,
+   15,  15,  15,  15,  15,  15,  15,  15,
+    5,   5,   5,   5,   5,   5,   5,   5,
+    0,   0,   0,   0,   0,   0,   0,   0,
+    0,   0,   0,   0,   0,   0,   0,   0,
+};
+
+/** @brief Bonus of a rook on each square, in both phases. */
+static const int8_t rook_table[64] = {
+    0,   0,   0,   0,   0,   0,   0,   0,
+    5,  10,  10,  10,  10,  10,  10,   5,
+   -5,   0,   0,   0,   0,   0,   0,  -5,
+   -5,   0,   0,   0,   0,   0,   0,  -5,
+   -5,   0,   0,   0,   0,   0,   0,  -5,
+   -5,   0,   0,   0,   0,   0,   0,  -5,
+   -5,   0,   0,   0,   0,   0,   0,  -5,
+    0,   0,   0,   5,   5,   0,   0,   0,
+};
+
+/** @brief Bonus of a knight on each square, in both phases. */
+static const int8_t knight_table[64] = {
+  -50, -40, -30, -30, -30, -30, -40, -50,
+  -40, -20,   0,   0,   0,   0, -20, -40,
+  -30,   0,  10,  15,  15,  10,   0, -30,
+  -30,   5,  15,  20,  20,  15,   5, -30,
+  -30,   0,  15,  20,  20,  15,   0, -30,
+  -30,   5,  10,  15,  15,  10,   5, -30,
+  -40, -20,   0,   5,   5,   0, -20, -40,
+  -50, -40, -30, -30, -30, -30, -40, -50,
+};
+
+/** @brief Bonus of a bishop on each square, in both phases. */
+static const int8_t bishop_table[64] = {
+  -20, -10, -10, -10, -10, -10, -10, -20,
+  -10,   0,   0,   0,   0,   0,   0, -10,
+  -10,   0,   5,  10,  10,   5,   0, -10,
+  -10,   5,   5,  10,  10,   5,   5, -10,
+  -10,   0,  10,  10,  10,  10,   0, -10,
+  -10,  10,  10,  10,  10,  10,  10, -10,
+  -10,   5,   0,   0,   0,   0,   5, -10,
+  -20, -10, -10, -10, -10, -10, -10, -20,
+};
+
+/** @brief Bonus of a queen on each square, in both phases. */
+static const int8_t queen_table[64] = {
+  -20, -10, -10,  -5,  -5, -10, -10, -20,
+  -10,   0,   0,   0,   0,   0,   0, -10,
+  -10,   0,   5,   5,   5,   5,   0, -10,
+   -5,   0,   5,   5,   5,   5,   0,  -5,
+    0,   0,   5,   5,   5,   5,   0,  -5,
+  -10,   5,   5,   5,   5,   5,   0, -10,
+  -10,   0,   5,   0,   0,   0,   0, -10,
+  -20, -10, -10,  -5,  -5, -10, -10, -20,
+};
+
+/** @brief Midgame bonus of the king on each square. */
+static const int8_t king_mg[64] = {
+  -30, -40, -40, -50, -50, -40, -40, -30,
+  -30, -40, -40, -50, -50, -40, -40, -30,
+  -30, -40, -40, -50, -50, -40, -40, -30,
+  -30, -40, -40, -50, -50, -40, -40, -30,
+  -20, -30, -30, -40, -40, -30, -30, -20,
+  -10, -20, -20, -20, -20, -20, -20, -10,
+   20,  20,   0,   0,   0,   0,  20,  20,
+   20,  30,  10,   0,   0,  10,  30,  20,
+};
+
+/** @brief Endgame bonus of the king on each square. */
+static const int8_t king_eg[64] = {
+  -50, -40, -30, -20, -20, -30, -40, -50,
+  -30, -20, -10,   0,   0, -10, -20, -30,
+  -30, -10,  20,  30,  30,  20, -10, -30,
+  -30, -10,  30,  40,  40,  30, -10, -30,
+  -30, -10,  30,  40,  40,  30, -10, -30,
+  -30, -10,  20,  30,  30,  20, -10, -30,
+  -30, -30,   0,   0,   0,   0, -30, -30,
+  -50, -30, -30, -30, -30, -30, -30, -50,
+};
+
+const int8_t *const psqt_mg[6] = {pawn_mg, rook_table, knight_table, bishop_table, queen_table, king_mg};
+const int8_t *const psqt_eg[6] = {pawn_eg, rook_table, knight_table, bishop_table, queen_table, king_eg};
+
+/**
+ * @brief Computes the evaluation terms of a position from scratch.
+ *
+ * This function adds every piece of the bitboards to empty terms, in the same way make_move adds the pieces it moves.
+ *
+ * @param bb Pointer to the position.
+ * @param eval Filled with the terms.
+ */
+void eval_compute(const struct Bitboard *bb, struct EvalState *eval) {
+  eval->mg = 0;
+  eval->eg = 0;
+  eval->phase = 0;
+
+  for (int color = WHITE; color <= BLACK; color++) {
+    for (int type = PAWN; type <= KING; type++) {
+      uint64_t pieces = bb->pieces[color][type];
+      while (pieces) {
+        eval_put_piece(eval, (enum PieceType) type, color == WHITE, bitboard_pop_lsb(&pieces));
+      }
+    }
+  }
+}
+
+/**
+ * @brief Evaluates a position statically.
+ *
+ * This function adds the pawn-structure terms to the midgame and endgame scores kept on the board, with the shield of each king
+ * that still stands on its first two ranks, then blends the two by the phase, so the weights shift gradually as pieces are
+ * traded, and returns the result for the side to move. The phase is capped, since promotions can raise it above its initial
+ * value.
+ *
+ * @param game Pointer to the game.
+ * @param pawns Table of the pawn structures already evaluated, or NULL to evaluate the pawns every time.
+ * @return Score of the position for the side to move, in centipawns.
+ */
+int evaluate(const struct Game *game, struct PawnTable *pawns) {
+  const struct Bitboard *bb = &game->board.bitboard;
+  const struct EvalState *eval = &game->board.eval;
+  const struct PawnEntry *structure;
+  struct PawnEntry local;
+
+  if (pawns != NULL) {
+    structure = pawn_probe(pawns, bb, game->pawnHash);
+  }
+  else {
+    pawn_evaluate(bb, &local);
+    structure = &local;
+  }
+
+  int mg = eval->mg + structure->mg;
+  int eg = eval->eg + structure->eg;
+  for (int color = WHITE; color <= BLACK; color++) {
+    int king = bitboard_lsb(bb->pieces[color][KING]);
+    int rank = color == WHITE ? SQUARE_Y(king) : 7 - SQUARE_Y(king);
+    if (rank <= 1) {
+      mg += color == WHITE ? structure->shield[color][SQUARE_X(king)] : -structure->shield[color][SQUARE_X(king)];
+    }
+  }
+
+  int phase = eval->phase < PHASE_MAX ? eval->phase : PHASE_MAX;
+  int score = (mg * phase + eg * (PHASE_MAX - phase)) / PHASE_MAX;
+
+  return game->isWhiteTurn ? score : -score;
+}
@@ -0,0 +1,88 @@
+/**
+ * @file evaluate.h
+ * @brief Header file containing the static evaluation of positions used by the search.
+ *
+ * Scores are in centipawns (a pawn is worth 100) and always from the point of view of the
+ * side to move, as negamax expects. The evaluation is material plus piece-square tables, with
+ * a midgame and an endgame weight per piece and square blended by the phase of the game. Its
+ * terms live in struct EvalState and are updated by make_move with every piece that moves, so
+ * evaluating a position reads three integers instead of scanning the board. The pawn-structure
+ * terms come from a pawn table, so they are only computed once per structure.
+ */
+
+#pragma once
+
+#include "../game.h"
+#include "pawns.h"
+
+/** @brief Phase of a position with all its knights, bishops, rooks and queens. */
+#define PHASE_MAX 24
+
+/** @brief Midgame value of each piece type (PAWN to KING) in centipawns; the king is never traded, so it is worth nothing. */
+extern const int piece_values_mg[6];
+
+/** @brief Endgame value of each piece type (PAWN to KING) in centipawns. */
+extern const int piece_values_eg[6];
+
+/** @brief Contribution of each piece type (PAWN to KING) to the phase. */
+extern const int phase_weights[6];
+
+/** @brief Midgame bonus of each piece type on each square, from white's side with rank 8 first. */
+extern const int8_t *const psqt_mg[6];
+
+/** @brief Endgame bonus of each piece type on each square, from white's side with rank 8 first. */
+extern const int8_t *const psqt_eg[6];
+
+/**
+ * @brief Adds a piece standing on a square to the evaluation terms.
+ *
+ * The tables are laid out as a board is read, rank 8 first, so a white piece on square sq reads entry sq ^ 56 and a black
+ * piece reads entry sq, which mirrors the board for black.
+ *
+ * @param eval Pointer to the terms.
+ * @param type Type of the piece.
+ * @param isWhite Whether the piece is white.
+ * @param sq Square of the piece.
+ */
+static inline void eval_put_piece(struct EvalState *eval, enum PieceType type, bool isWhite, int sq) {
+  int index = isWhite ? sq ^ 56 : sq;
+  int sign = isWhite ? 1 : -1;
+  eval->mg += sign * (piece_values_mg[type] + psqt_mg[type][index]);
+  eval->eg += sign * (piece_values_eg[type] + psqt_eg[type][index]);
+  eval->phase += phase_weights[type];
+}
+
+/**
+ * @brief Removes a piece standing on a square from the evaluation terms.
+ *
+ * @param eval Pointer to the terms.
+ * @param type Type of the piece.
+ * @param isWhite Whether the piece is white.
+ * @param sq Square of the piece.
+ */
+static inline void eval_remove_piece(struct EvalState *eval, enum PieceType type, bool isWhite, int sq) {
+  int index = isWhite ? sq ^ 56 : sq;
+  int sign = isWhite ? 1 : -1;
+  eval->mg -= sign * (piece_values_mg[type] + psqt_mg[type][index]);
+  eval->eg -= sign * (piece_values_eg[type] + psqt_eg[type][index]);
+  eval->phase -= phase_weights[type];
+}
+
+/**
+ * @brief Computes the evaluation terms of a position from scratch.
+ *
+ * Only needed when a board is set up and when the incremental terms are checked.
+ *
+ * @param bb Pointer to the position.
+ * @param eval Filled with the terms.
+ */
+void eval_compute(const struct Bitboard *bb, struct EvalState *eval);
+
+/**
+ * @brief Evaluates a position statically.
+ *
+ * @param game Pointer to the game.
+ * @param pawns Table of the pawn structures already evaluated, or NULL to evaluate the pawns every time.
+ * @return Score of the position for the side to move, in centipawns.
+ */
+int evaluate(const struct Game *game, struct PawnTable *pawns);
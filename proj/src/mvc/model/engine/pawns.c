@@ -0,0 +1,179 @@
+/**
+ * @file pawns.c
+ * @brief Implementation of the pawn-structure evaluation and its hash table.
+ *
+ * The terms are found set-wise on the pawn bitboards: files are filled to find the neighbours
+ * of a pawn, and the spans in front of the pawns to find the passed and backward ones.
+ */
+
+#include <string.h>
+
+#include "pawns.h"
+
+/** @brief Midgame and endgame penalty per pawn beyond the first on a file. */
+static const int doubled_penalty[2] = {10, 20};
+
+/** @brief Midgame and endgame penalty of a pawn with no pawn of its color on the neighbouring files. */
+static const int isolated_penalty[2] = {10, 15};
+
+/** @brief Midgame and endgame penalty of a pawn that its neighbours can no longer protect and cannot safely advance. */
+static const int backward_penalty[2] = {8, 10};
+
+/** @brief Midgame bonus of a passed pawn, by rank from its own side. */
+static const int passed_bonus_mg[8] = {0, 5, 10, 15, 25, 40, 60, 0};
+
+/** @brief Endgame bonus of a passed pawn, by rank from its own side. */
+static const int passed_bonus_eg[8] = {0, 10, 20, 35, 60, 90, 130, 0};
+
+/** @brief Midgame bonus of a shield pawn one and two ranks in front of the king. */
+static const int shield_bonus[2] = {12, 6};
+
+/**
+ * @brief Returns the squares of a file.
+ *
+ * @param file File index, 0 for file a.
+ * @return Set of the squares of the file, or 0 outside the board.
+ */
+static uint64_t file_mask(int file) {
+  return file >= 0 && file < 8 ? FILE_A << file : 0;
+}
+
+/**
+ * @brief Returns the squares of the ranks strictly in front of a square, from the point of view of one color.
+ *
+ * @param isWhite Whether the ranks in front are the higher ones.
+ * @param sq The square.
+ * @return Set of the squares of those ranks.
+ */
+static uint64_t ranks_ahead(bool isWhite, int sq) {
+  int rank = SQUARE_Y(sq);
+  if (isWhite) {
+    return rank == 7 ? 0 : ~(uint64_t) 0 << (8 * (rank + 1));
+  }
+  return rank == 0 ? 0 : ~(uint64_t) 0 >> (8 * (8 - rank));
+}
+
+/**
+ * @brief Evaluates the pawns of one color.
+ *
+ * @param bb Pointer to the position.
+ * @param isWhite Color of the pawns.
+ * @param mg Incremented with the midgame score of the pawns.
+ * @param eg Incremented with the endgame score of the pawns.
+ * @param passed Filled with the passed pawns of the color.
+ */
+static void evaluate_color(const struct Bitboard *bb, bool isWhite, int *mg, int *eg, uint64_t *passed) {
+  uint64_t own = bb->pieces[COLOR(isWhite)][PAWN];
+  uint64_t enemy = bb->pieces[COLOR(!isWhite)][PAWN];
+  uint64_t pawns = own;
+
+  *passed = 0;
+  for (int file = 0; file < 8; file++) {
+    int count = bitboard_count(own & file_mask(file));
+    if (count > 1) {
+      *mg -= doubled_penalty[0] * (count - 1);
+      *eg -= doubled_penalty[1] * (count - 1);
+    }
+  }
+
+  while (pawns) {
+    int sq = bitboard_pop_lsb(&pawns);
+    int file = SQUARE_X(sq);
+    int rank = isWhite ? SQUARE_Y(sq) : 7 - SQUARE_Y(sq);
+    uint64_t neighbours = file_mask(file - 1) | file_mask(file + 1);
+    uint64_t ahead = ranks_ahead(isWhite, sq);
+
+    if (!(enemy & ahead & (neighbours | file_mask(file)))) {
+      *passed |= SQUARE_BIT(sq);
+      *mg += passed_bonus_mg[rank];
+      *eg += passed_bonus_eg[rank];
+    }
+
+    if (!(own & neighbours)) {
+      *mg -= isolated_penalty[0];
+      *eg -= isolated_penalty[1];
+    }
+    else if (!(own & neighbours & ~ahead)) {
+      // every neighbour is ahead: backward if an enemy pawn controls the square in front
+      int stop = isWhite ? sq + 8 : sq - 8;
+      if (pawn_attacks(isWhite, stop) & enemy) {
+        *mg -= backward_penalty[0];
+        *eg -= backward_penalty[1];
+      }
+    }
+  }
+}
+
+/**
+ * @brief Scores the pawn shield of a king standing on each file.
+ *
+ * @param bb Pointer to the position.
+ * @param isWhite Color of the king and its pawns.
+ * @param shield Filled with the score of each king file.
+ */
+static void evaluate_shield(const struct Bitboard *bb, bool isWhite, int8_t shield[8]) {
+  uint64_t own = bb->pieces[COLOR(isWhite)][PAWN];
+  uint64_t near = isWhite ? RANK_2 : RANK_7;
+  uint64_t far = isWhite ? RANK_3 : RANK_6;
+
+  for (int file = 0; file < 8; file++) {
+    uint64_t files = file_mask(file - 1) | file_mask(file) | file_mask(file + 1);
+    shield[file] = (int8_t) (shield_bonus[0] * bitboard_count(own & files & near) + shield_bonus[1] * bitboard_count(own & files & far));
+  }
+}
+
+/**
+ * @brief Empties a pawn table and resets its counters.
+ *
+ * @param table Pointer to the table.
+ */
+void pawn_table_clear(struct PawnTable *table) {
+  memset(table, 0, sizeof(*table));
+}
+
+/**
+ * @brief Evaluates a pawn structure.
+ *
+ * This function scores doubled, isolated, backward and passed pawns for both colors, and the shield each color would have with
+ * its king on each file.
+ *
+ * @param bb Pointer to the position; only its pawns are read.
+ * @param entry Filled with the evaluation; its key is left untouched.
+ */
+void pawn_evaluate(const struct Bitboard *bb, struct PawnEntry *entry) {
+  int mg[2] = {0, 0};
+  int eg[2] = {0, 0};
+  uint64_t passed[2];
+
+  for (int color = WHITE; color <= BLACK; color++) {
+    evaluate_color(bb, color == WHITE, &mg[color], &eg[color], &passed[color]);
+    evaluate_shield(bb, color == WHITE, entry->shield[color]);
+  }
+  entry->passed = passed[WHITE] | passed[BLACK];
+  entry->mg = (int16_t) (mg[WHITE] - mg[BLACK]);
+  entry->eg = (int16_t) (eg[WHITE] - eg[BLACK]);
+}
+
+/**
+ * @brief Returns the evaluation of the pawn structure of a position, from the table if it holds it.
+ *
+ * This function replaces the entry of the hash on a miss. A position without pawns has a pawn hash of 0, like an empty entry,
+ * so it is evaluated every time; there is nothing to evaluate then anyway.
+ *
+ * @param table Pointer to the table.
+ * @param bb Pointer to the position.
+ * @param pawnHash Pawn hash of the position.
+ * @return Pointer to the entry of the structure, valid until the next probe.
+ */
+const struct PawnEntry *pawn_probe(struct PawnTable *table, const struct Bitboard *bb, uint64_t pawnHash) {
+  struct PawnEntry *entry = &table->entries[pawnHash & (PAWN_TABLE_SIZE - 1)];
+
+  table->probes++;
+  if (entry->key == pawnHash && pawnHash != 0) {
+    table->hits++;
+    return entry;
+  }
+  pawn_evaluate(bb, entry);
+  entry->key = pawnHash;
+  return entry;
+}
@@ -0,0 +1,64 @@
+/**
+ * @file pawns.h
+ * @brief Header file containing the pawn-structure evaluation and its hash table.
+ *
+ * Doubled, isolated, backward and passed pawns and the pawn shield in front of the king only
+ * depend on where the pawns stand, which changes with few moves, so the search meets the same
+ * pawn structure over and over. Each structure is evaluated once and kept in a small table
+ * indexed by the pawn hash of the game; the shield is stored for every file the king could
+ * stand on, so the king square does not have to be part of the key.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "../bitboard/bitboard.h"
+
+/** @brief Number of entries of a pawn table; a power of two. */
+#define PAWN_TABLE_SIZE 4096
+
+/**
+ * @brief Structure representing an evaluated pawn structure.
+ */
+struct PawnEntry {
+  uint64_t key;        /**< pawn hash of the structure, 0 if the entry is empty */
+  uint64_t passed;     /**< passed pawns of both colors */
+  int16_t mg;          /**< midgame score of the structure, white minus black */
+  int16_t eg;          /**< endgame score of the structure, white minus black */
+  int8_t shield[2][8]; /**< midgame score of the pawns in front of the king, per color and king file */
+};
+
+/**
+ * @brief Structure representing a table of evaluated pawn structures, owned by one search.
+ */
+struct PawnTable {
+  struct PawnEntry entries[PAWN_TABLE_SIZE]; /**< entries, indexed by the low bits of the pawn hash */
+  uint64_t probes;                           /**< lookups since the last clear */
+  uint64_t hits;                             /**< lookups that found their structure */
+};
+
+/**
+ * @brief Empties a pawn table and resets its counters.
+ *
+ * @param table Pointer to the table.
+ */
+void pawn_table_clear(struct PawnTable *table);
+
+/**
+ * @brief Evaluates a pawn structure.
+ *
+ * @param bb Pointer to the position; only its pawns are read.
+ * @param entry Filled with the evaluation; its key is left untouched.
+ */
+void pawn_evaluate(const struct Bitboard *bb, struct PawnEntry *entry);
+
+/**
+ * @brief Returns the evaluation of the pawn structure of a position, from the table if it holds it.
+ *
+ * @param table Pointer to the table.
+ * @param bb Pointer to the position.
+ * @param pawnHash Pawn hash of the position.
+ * @return Pointer to the entry of the structure, valid until the next probe.
+ */
+const struct PawnEntry *pawn_probe(struct PawnTable *table, const struct Bitboard *bb, uint64_t pawnHash);
@@ -0,0 +1,676 @@
+/**
+ * @file search.c
+ * @brief Implementation of the computer opponent: an iterative deepening alpha-beta search.
+ *
+ * The search plays the moves on the game itself and takes each one back before returning, so
+ * between two slices the game is exactly in the position the player sees.
+ */
+
+#include <string.h>
+
+#include "search.h"
+#include "evaluate.h"
+#include "see.h"
+#include "timeman.h"
+#include "../tablebase/tablebase.h"
+#include "../../../utils/timing.h"
+
+const struct SearchLimits engine_levels[ENGINE_LEVELS] = {
+  {1, 1000, 200000},
+  {2, 10000, 500000},
+  {3, 100000, 1000000},
+  {5, 1000000, 2000000},
+  {64, 10000000, 5000000},
+};
+
+const struct SearchOptions search_default_options = {true, true, true, true, true, true, true, true, true, true};
+
+/** @brief Nodes searched between two reads of the clock. */
+#define CHECK_INTERVAL 1024
+
+/**
+ * @brief Initializes a computer player.
+ *
+ * @param engine Pointer to the engine.
+ * @param level Strength level, clamped to 1..ENGINE_LEVELS.
+ * @param tt Transposition table to search with, or NULL.
+ */
+void engine_init(struct Engine *engine, int level, struct TTable *tt) {
+  if (level < 1) {
+    level = 1;
+  }
+  if (level > ENGINE_LEVELS) {
+    level = ENGINE_LEVELS;
+  }
+  engine->level = level;
+  engine->limits = engine_levels[level - 1];
+  engine->tt = tt;
+  engine->options = search_default_options;
+  engine->startDepth = 1;
+  engine->abort = NULL;
+  engine->agesTable = true;
+  engine->clock = NULL;
+  engine->thinking = false;
+  engine->bestMove = NO_MOVE;
+  memset(engine->history, 0, sizeof(engine->history));
+  pawn_table_clear(&engine->pawns);
+}
+
+/**
+ * @brief Checks whether another thread asked the search to end.
+ *
+ * @param engine Pointer to the engine.
+ * @return true if the abort flag of the engine is set, false otherwise.
+ */
+static bool is_aborted(const struct Engine *engine) {
+  return engine->abort != NULL && __atomic_load_n(engine->abort, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Checks whether the search must stop, reading the clock and the abort flag only every CHECK_INTERVAL nodes.
+ *
+ * @param engine Pointer to the engine.
+ * @return true if the search must stop, false otherwise.
+ */
+static bool should_stop(struct Engine *engine) {
+  if (engine->stopped) {
+    return true;
+  }
+  if (engine->nodes >= engine->limits.nodes || engine->nodes >= engine->stopNodes) {
+    engine->stopped = true;
+  }
+  else if ((engine->nodes & (CHECK_INTERVAL - 1)) == 0 && (timing_now_us() >= engine->stopUs || is_aborted(engine))) {
+    engine->stopped = true;
+  }
+  return engine->stopped;
+}
+
+/** @brief Ordering score of the hash move. */
+#define ORDER_HASH (1 << 30)
+
+/** @brief Ordering score added to captures and promotions. */
+#define ORDER_CAPTURE (1 << 24)
+
+/** @brief Ordering score of the first killer move; the second one scores one less. */
+#define ORDER_KILLER (1 << 23)
+
+/** @brief History scores are halved when one reaches this value, so they stay below the killers. */
+#define HISTORY_MAX (1 << 20)
+
+/** @brief Piece values used to order captures (PAWN to KING); the king ranks as the most valuable attacker. */
+static const int order_values[6] = {100, 500, 320, 330, 900, 2000};
+
+/**
+ * @brief Returns the type of the piece on a square, through the square index.
+ *
+ * @param game Pointer to the game.
+ * @param sq Square index, which must be occupied.
+ * @return Type of the piece.
+ */
+static inline enum PieceType piece_on(const struct Game *game, int sq) {
+  return game->board.pieces[game->board.squareSlot[sq]].type;
+}
+
+/**
+ * @brief Gives every move of a list an ordering score, higher scores being searched first.
+ *
+ * This function ranks the hash move first, then the captures and promotions by MVV-LVA, then the killer moves, then the other quiet moves by their history score, and last the captures that lose material by static exchange evaluation. A technique that is turned off leaves its moves in generator order within their group.
+ *
+ * @param engine Pointer to the engine.
+ * @param game Pointer to the game.
+ * @param list Pointer to the move list.
+ * @param scores Filled with the score of each move.
+ * @param hashMove Move of the transposition table, or NO_MOVE.
+ * @param ply Distance from the root.
+ */
+static void score_moves(const struct Engine *engine, const struct Game *game, const struct MoveBuffer *list, int *scores, uint16_t hashMove, int ply) {
+  const struct SearchOptions *options = &engine->options;
+  int color = COLOR(game->isWhiteTurn);
+
+  for (int i = 0; i < list->index; i++) {
+    uint16_t move = list->moves[i];
+    int from = MOVE_FROM(move);
+    int to = MOVE_TO(move);
+
+    if (move == hashMove && options->hashMove) {
+      scores[i] = ORDER_HASH;
+    }
+    else if (MOVE_IS_CAPTURE(move) || MOVE_IS_PROMOTION(move)) {
+      scores[i] = ORDER_CAPTURE;
+      if (options->mvvLva) {
+        if (MOVE_IS_CAPTURE(move)) {
+          enum PieceType victim = MOVE_FLAGS(move) == MOVE_EP_CAPTURE ? PAWN : piece_on(game, to);
+          enum PieceType attacker = piece_on(game, from);
+          scores[i] += order_values[victim] * 16 - order_values[attacker] / 16;
+        }
+        if (MOVE_IS_PROMOTION(move)) {
+          scores[i] += order_values[move_promotion(move)] * 16;
+        }
+      }
+      // only a capture by a more valuable piece can lose material
+      if (options->see && MOVE_IS_CAPTURE(move) && MOVE_FLAGS(move) != MOVE_EP_CAPTURE &&
+          order_values[piece_on(game, from)] > order_values[piece_on(game, to)] && see(&game->board.bitboard, move) < 0) {
+        scores[i] -= 2 * ORDER_CAPTURE;
+      }
+    }
+    else if (options->killers && ply < MAX_SEARCH_PLY && move == engine->killers[ply][0]) {
+      scores[i] = ORDER_KILLER;
+    }
+    else if (options->killers && ply < MAX_SEARCH_PLY && move == engine->killers[ply][1]) {
+      scores[i] = ORDER_KILLER - 1;
+    }
+    else {
+      scores[i] = options->history ? engine->history[color][from][to] : 0;
+    }
+  }
+}
+
+/**
+ * @brief Moves the best scored of the remaining moves to a position of the list.
+ *
+ * Picking one move at a time costs less than sorting the list, since most nodes cut off after a few moves.
+ *
+ * @param list Pointer to the move list.
+ * @param scores Scores of the moves, kept in step with the list.
+ * @param index Position to fill; the moves before it have been searched.
+ */
+static void pick_move(struct MoveBuffer *list, int *scores, int index) {
+  int best = index;
+
+  for (int i = index + 1; i < list->index; i++) {
+    if (scores[i] > scores[best]) {
+      best = i;
+    }
+  }
+
+  uint16_t move = list->moves[index];
+  int score = scores[index];
+  list->moves[index] = list->moves[best];
+  scores[index] = scores[best];
+  list->moves[best] = move;
+  scores[best] = score;
+}
+
+/**
+ * @brief Records a quiet move that caused a cutoff as a killer of its ply and in the history.
+ *
+ * @param engine Pointer to the engine.
+ * @param game Pointer to the game.
+ * @param move The move.
+ * @param depth Remaining depth of the node; deeper cutoffs weigh more.
+ * @param ply Distance from the root.
+ */
+static void update_quiet_stats(struct Engine *engine, const struct Game *game, uint16_t move, int depth, int ply) {
+  int color = COLOR(game->isWhiteTurn);
+  int *entry = &engine->history[color][MOVE_FROM(move)][MOVE_TO(move)];
+
+  if (ply < MAX_SEARCH_PLY && engine->killers[ply][0] != move) {
+    engine->killers[ply][1] = engine->killers[ply][0];
+    engine->killers[ply][0] = move;
+  }
+
+  *entry += depth * depth;
+  if (*entry >= HISTORY_MAX) {
+    for (int c = 0; c < 2; c++) {
+      for (int from = 0; from < 64; from++) {
+        for (int to = 0; to < 64; to++) {
+          engine->history[c][from][to] /= 2;
+        }
+      }
+    }
+  }
+}
+
+/**
+ * @brief Checks if the side to move has a piece other than pawns and its king.
+ *
+ * Null-move pruning assumes passing is never better than moving, which fails in the zugzwangs typical of king and pawn endings.
+ *
+ * @param game Pointer to the game.
+ * @return true if the side to move has a knight, bishop, rook or queen.
+ */
+static bool has_non_pawn_material(const struct Game *game) {
+  const uint64_t *pieces = game->board.bitboard.pieces[COLOR(game->isWhiteTurn)];
+  return (pieces[KNIGHT] | pieces[BISHOP] | pieces[ROOK] | pieces[QUEEN]) != 0;
+}
+
+/**
+ * @brief Evaluates a position statically, with the pawn table of the engine if it is in use.
+ *
+ * @param engine Pointer to the engine.
+ * @param game Pointer to the game.
+ * @return Score of the position for the side to move.
+ */
+static int static_eval(struct Engine *engine, const struct Game *game) {
+  return evaluate(game, engine->options.pawnTable ? &engine->pawns : NULL);
+}
+
+/**
+ * @brief Scores a position whose outcome the tablebases know.
+ *
+ * A win alone does not say which move makes progress, so the static evaluation is added to the score of a win (and taken from the score of a loss): among the winning moves, the search then prefers the ones its evaluation likes, such as promoting or driving the king to the edge, until a mate comes within its horizon. A nearer win also scores higher.
+ *
+ * @param engine Pointer to the engine.
+ * @param game Pointer to the game.
+ * @param wdl Outcome of the position for the side to move.
+ * @param ply Distance of the position from the root.
+ * @return Score of the position for the side to move.
+ */
+static int tablebase_score(struct Engine *engine, const struct Game *game, enum TBWdl wdl, int ply) {
+  if (wdl == TB_DRAW) {
+    return 0;
+  }
+  int eval = static_eval(engine, game);
+  if (eval > TB_EVAL_MARGIN) {
+    eval = TB_EVAL_MARGIN;
+  }
+  if (eval < -TB_EVAL_MARGIN) {
+    eval = -TB_EVAL_MARGIN;
+  }
+  return wdl == TB_WIN ? TB_WIN_SCORE - ply + eval : -TB_WIN_SCORE + ply + eval;
+}
+
+/**
+ * @brief Moves a move of a move list to its front, if the list has it.
+ *
+ * @param list Pointer to the move list.
+ * @param move Move to search first.
+ */
+static void move_to_front(struct MoveBuffer *list, uint16_t move) {
+  for (int i = 0; i < list->index; i++) {
+    if (list->moves[i] == move) {
+      list->moves[i] = list->moves[0];
+      list->moves[0] = move;
+      return;
+    }
+  }
+}
+
+/**
+ * @brief Searches the captures and promotions of a position until it is quiet, so the horizon never falls in the middle of an exchange.
+ *
+ * This function lets the side to move stand pat on the static evaluation, then tries the captures and queen promotions, best
+ * exchange first, skipping those that lose material. A side in check has no stand pat and searches all its evasions, so mates
+ * along a capture sequence are still found.
+ *
+ * @param engine Pointer to the engine.
+ * @param game Pointer to the game; it is left in the position it was given in.
+ * @param alpha Lower bound of the window.
+ * @param beta Upper bound of the window.
+ * @param ply Distance from the root.
+ * @return Score of the position for the side to move, or 0 if the search was stopped.
+ */
+static int quiesce(struct Engine *engine, struct Game *game, int alpha, int beta, int ply) {
+  const struct Bitboard *bb = &game->board.bitboard;
+  struct MoveBuffer list;
+  int scores[MAX_MOVES];
+  int best = -INFINITE_SCORE;
+
+  engine->nodes++;
+  if (should_stop(engine)) {
+    return 0;
+  }
+  if (is_draw(game)) {
+    return 0;
+  }
+
+  bool inCheck = is_check(game);
+  if (inCheck) {
+    generate_legal_moves(bb, &list);
+    if (list.index == 0) {
+      return -MATE_SCORE + ply;
+    }
+    score_moves(engine, game, &list, scores, NO_MOVE, ply);
+  }
+  else {
+    best = static_eval(engine, game);
+    if (best >= beta || ply >= 2 * MAX_SEARCH_PLY) {
+      return best;
+    }
+    if (best > alpha) {
+      alpha = best;
+    }
+
+    struct MoveBuffer captures;
+    generate_captures(bb, &captures);
+    list.index = 0;
+    for (int i = 0; i < captures.index; i++) {
+      uint16_t move = captures.moves[i];
+      if (MOVE_IS_PROMOTION(move) && move_promotion(move) != QUEEN) {
+        continue;
+      }
+      int gain = engine->options.see ? see(bb, move) : 0;
+      if (gain < 0 || !is_pseudo_legal_move_legal(bb, move)) {
+        continue;
+      }
+      scores[list.index] = gain;
+      list.moves[list.index++] = move;
+    }
+    if (!engine->options.see) {
+      score_moves(engine, game, &list, scores, NO_MOVE, ply);
+    }
+  }
+
+  for (int i = 0; i < list.index; i++) {
+    pick_move(&list, scores, i);
+    if (make_move(game, list.moves[i]) != 0) {
+      // the undo stack of the game is full: the position is a leaf
+      return static_eval(engine, game);
+    }
+    int score = -quiesce(engine, game, -beta, -alpha, ply + 1);
+    unmake_move(game);
+
+    if (engine->stopped) {
+      return 0;
+    }
+    if (score > best) {
+      best = score;
+      if (score > alpha) {
+        alpha = score;
+        if (alpha >= beta) {
+          break;
+        }
+      }
+    }
+  }
+  return best;
+}
+
+/**
+ * @brief Searches a position with negamax alpha-beta.
+ *
+ * This function scores repetitions, the fifty-move rule and insufficient material as draws, and hands the positions at the horizon to the quiescence search. Positions without legal moves score as mates or stalemates. The search then looks the position up in the transposition table: a deep enough entry whose bound settles the window ends the search. Null-move pruning comes next, then the moves in order, the first one with the full window and the others, with principal variation search, with a null window that is only widened when they beat alpha. Late quiet moves are searched to a reduced depth first and only searched again at full depth if they beat alpha. A position whose moves no longer fit on the undo stack of the game is a leaf, scored by the evaluation.
+ *
+ * @param engine Pointer to the engine.
+ * @param game Pointer to the game; it is left in the position it was given in.
+ * @param depth Remaining depth in plies.
+ * @param alpha Lower bound of the window.
+ * @param beta Upper bound of the window.
+ * @param ply Distance from the root.
+ * @param allowNull Whether a null move may be tried (never twice in a row).
+ * @return Score of the position for the side to move, or 0 if the search was stopped.
+ */
+static int search(struct Engine *engine, struct Game *game, int depth, int alpha, int beta, int ply, bool allowNull) {
+  const struct SearchOptions *options = &engine->options;
+  struct MoveBuffer list;
+  int scores[MAX_MOVES];
+  struct TTEntry entry = {NO_MOVE, 0, 0, TT_NONE};
+  int best = -INFINITE_SCORE;
+  uint16_t bestMove = NO_MOVE;
+  int alphaOrig = alpha;
+
+  engine->nodes++;
+  if (should_stop(engine)) {
+    return 0;
+  }
+  if (game->halfmoveClock >= 100 || count_repetitions(game) > 0 || is_draw(game)) {
+    return 0;
+  }
+  if (options->tablebases && ply > 0) {
+    enum TBWdl wdl = tb_probe_wdl(game);
+    if (wdl != TB_UNKNOWN) {
+      return tablebase_score(engine, game, wdl, ply);
+    }
+  }
+
+  if (depth <= 0) {
+    return quiesce(engine, game, alpha, beta, ply);
+  }
+
+  bool inCheck = is_check(game);
+  generate_legal_moves(&game->board.bitboard, &list);
+  if (list.index == 0) {
+    return inCheck ? -MATE_SCORE + ply : 0;
+  }
+
+  if (engine->tt != NULL && tt_probe(engine->tt, game->hash, ply, &entry) && entry.depth >= depth) {
+    if (entry.bound == TT_EXACT || (entry.bound == TT_LOWER && entry.score >= beta) || (entry.bound == TT_UPPER && entry.score <= alpha)) {
+      return entry.score;
+    }
+  }
+
+  if (options->nullMove && allowNull && depth >= 3 && !inCheck && beta < MATE_BOUND && has_non_pawn_material(game) && static_eval(engine, game) >= beta) {
+    int reduction = depth >= 7 ? 3 : 2;
+    if (make_null_move(game) != 0) {
+      return static_eval(engine, game);
+    }
+    int score = -search(engine, game, depth - 1 - reduction, -beta, -beta + 1, ply + 1, false);
+    unmake_null_move(game);
+
+    if (engine->stopped) {
+      return 0;
+    }
+    if (score >= beta) {
+      return score >= MATE_BOUND ? beta : score;
+    }
+  }
+
+  score_moves(engine, game, &list, scores, entry.move, ply);
+  for (int i = 0; i < list.index; i++) {
+    pick_move(&list, scores, i);
+    uint16_t move = list.moves[i];
+    bool quiet = !MOVE_IS_CAPTURE(move) && !MOVE_IS_PROMOTION(move);
+    int score;
+
+    if (make_move(game, move) != 0) {
+      return static_eval(engine, game);
+    }
+    bool givesCheck = is_check(game);
+
+    if (i == 0) {
+      score = -search(engine, game, depth - 1, -beta, -alpha, ply + 1, true);
+    }
+    else {
+      bool searchFull = true;
+      if (options->lmr && depth >= 3 && i >= 3 && quiet && !inCheck && !givesCheck && scores[i] < ORDER_KILLER - 1) {
+        int reduction = i >= 6 && depth >= 6 ? 2 : 1;
+        score = -search(engine, game, depth - 1 - reduction, -alpha - 1, -alpha, ply + 1, true);
+        searchFull = score > alpha;
+      }
+      if (searchFull && options->pvs) {
+        score = -search(engine, game, depth - 1, -alpha - 1, -alpha, ply + 1, true);
+        searchFull = score > alpha && score < beta;
+      }
+      if (searchFull) {
+        score = -search(engine, game, depth - 1, -beta, -alpha, ply + 1, true);
+      }
+    }
+    unmake_move(game);
+
+    if (engine->stopped) {
+      return 0;
+    }
+    if (score > best) {
+      best = score;
+      bestMove = move;
+      if (score > alpha) {
+        alpha = score;
+        if (alpha >= beta) {
+          if (quiet) {
+            update_quiet_stats(engine, game, move, depth, ply);
+          }
+          break;
+        }
+      }
+    }
+  }
+
+  if (engine->tt != NULL) {
+    enum TTBound bound = best >= beta ? TT_LOWER : best > alphaOrig ? TT_EXACT : TT_UPPER;
+    tt_store(engine->tt, game->hash, ply, depth, bound, best, bestMove);
+  }
+  return best;
+}
+
+/**
+ * @brief Starts a search of the current position.
+ *
+ * @param engine Pointer to the engine.
+ * @param game Pointer to the game.
+ */
+static void engine_start(struct Engine *engine, struct Game *game) {
+  engine->thinking = true;
+  engine->rootHash = game->hash;
+  engine->rootPly = game->undoIndex;
+  generate_legal_moves(&game->board.bitboard, &engine->rootMoves);
+  int scores[MAX_MOVES];
+  score_moves(engine, game, &engine->rootMoves, scores, NO_MOVE, 0);
+  for (int i = 0; i < engine->rootMoves.index; i++) {
+    pick_move(&engine->rootMoves, scores, i);
+  }
+  engine->rootIndex = 0;
+  engine->depth = engine->startDepth;
+  engine->alpha = -INFINITE_SCORE;
+  engine->iterationMove = NO_MOVE;
+  engine->bestMove = engine->rootMoves.index > 0 ? engine->rootMoves.moves[0] : NO_MOVE;
+  engine->bestScore = 0;
+  engine->completedDepth = 0;
+  engine->nodes = 0;
+  engine->startUs = timing_now_us();
+  if (engine->clock != NULL) {
+    time_budget(engine->clock, game->fullmoveNumber, engine->limits.timeUs, &engine->budget);
+  }
+  else {
+    engine->budget.softUs = engine->limits.timeUs;
+    engine->budget.hardUs = engine->limits.timeUs;
+  }
+  engine->instability = 0;
+  memset(engine->killers, 0, sizeof(engine->killers));
+  for (int c = 0; c < 2; c++) {
+    for (int from = 0; from < 64; from++) {
+      for (int to = 0; to < 64; to++) {
+        engine->history[c][from][to] /= 8;
+      }
+    }
+  }
+  if (engine->tt != NULL && engine->agesTable) {
+    tt_new_search(engine->tt);
+  }
+}
+
+/**
+ * @brief Ends a search, keeping the best move of an unfinished iteration if it already beat the previous one.
+ *
+ * The best move of the previous iteration is always searched first, so any move that replaced it in the current iteration was found to be better.
+ *
+ * @param engine Pointer to the engine.
+ * @return true, for engine_think to return.
+ */
+static bool engine_finish(struct Engine *engine) {
+  if (engine->iterationMove != NO_MOVE && engine->rootIndex > 0) {
+    engine->bestMove = engine->iterationMove;
+    engine->bestScore = engine->alpha;
+  }
+  engine->thinking = false;
+  return true;
+}
+
+/**
+ * @brief Searches the current position for at most a slice of time and nodes.
+ *
+ * This function runs the iterations of the iterative deepening one root move at a time. When the slice runs out in the middle of a root move, that move is searched again from the start on the next call; the moves already searched keep their result, and of the move it stopped in only what the transposition table kept is not lost. The node bound is checked at every node, the time only every CHECK_INTERVAL nodes, so a caller that knows the speed of the search can bound a slice more tightly with nodes. A new iteration only starts before the soft deadline of the time budget, later the more the best move changed in the last iterations; the hard deadline ends the search wherever it is. A root with a single legal move is answered at once.
+ *
+ * @param engine Pointer to the engine.
+ * @param game Pointer to the game.
+ * @param sliceUs Longest time to search before returning, in microseconds.
+ * @param sliceNodes Most nodes to search before returning, or 0 for no bound.
+ * @return true if the search is over and engine->bestMove holds the move to play (NO_MOVE if there is none), false otherwise.
+ */
+bool engine_think(struct Engine *engine, struct Game *game, uint64_t sliceUs, uint64_t sliceNodes) {
+  if (!engine->thinking || engine->rootHash != game->hash || engine->rootPly != game->undoIndex) {
+    engine_start(engine, game);
+  }
+  if (engine->rootMoves.index <= 1) {
+    engine->thinking = false;
+    return true;
+  }
+
+  uint64_t now = timing_now_us();
+  uint64_t moveEnd = engine->startUs + engine->budget.hardUs;
+  engine->stopUs = now + sliceUs < moveEnd ? now + sliceUs : moveEnd;
+  engine->sliceStartNodes = engine->nodes;
+  engine->stopNodes = sliceNodes > 0 ? engine->nodes + sliceNodes : UINT64_MAX;
+  engine->stopped = false;
+
+  for (;;) {
+    if (engine->rootIndex == 0 && (engine->depth > engine->limits.depth || now >= moveEnd || engine->nodes >= engine->limits.nodes || is_aborted(engine))) {
+      return engine_finish(engine);
+    }
+
+    for (; engine->rootIndex < engine->rootMoves.index; engine->rootIndex++) {
+      uint16_t move = engine->rootMoves.moves[engine->rootIndex];
+      if (make_move(game, move) != 0) {
+        return engine_finish(engine);
+      }
+      int score;
+      if (engine->options.pvs && engine->rootIndex > 0) {
+        score = -search(engine, game, engine->depth - 1, -engine->alpha - 1, -engine->alpha, 1, true);
+        if (score > engine->alpha && !engine->stopped) {
+          score = -search(engine, game, engine->depth - 1, -INFINITE_SCORE, -engine->alpha, 1, true);
+        }
+      }
+      else {
+        score = -search(engine, game, engine->depth - 1, -INFINITE_SCORE, -engine->alpha, 1, true);
+      }
+      unmake_move(game);
+
+      if (engine->stopped) {
+        break;
+      }
+      if (score > engine->alpha) {
+        engine->alpha = score;
+        engine->iterationMove = move;
+      }
+    }
+
+    now = timing_now_us();
+    if (engine->stopped) {
+      if (now >= moveEnd || engine->nodes >= engine->limits.nodes || is_aborted(engine)) {
+        return engine_finish(engine);
+      }
+      return false;
+    }
+
+    // iteration complete: its best move is searched first in the next one
+    engine->instability /= 2;
+    if (engine->completedDepth > 0 && engine->iterationMove != engine->bestMove) {
+      engine->instability += TM_INSTABILITY_UNIT;
+    }
+    engine->bestMove = engine->iterationMove;
+    engine->bestScore = engine->alpha;
+    engine->completedDepth = engine->depth;
+    if (engine->depth <= MAX_SEARCH_PLY) {
+      engine->depthNodes[engine->depth] = engine->nodes;
+      engine->depthUs[engine->depth] = now - engine->startUs;
+    }
+    move_to_front(&engine->rootMoves, engine->bestMove);
+    if (engine->tt != NULL) {
+      tt_store(engine->tt, game->hash, 0, engine->depth, TT_EXACT, engine->bestScore, engine->bestMove);
+    }
+    engine->depth++;
+    engine->rootIndex = 0;
+    engine->alpha = -INFINITE_SCORE;
+    engine->iterationMove = NO_MOVE;
+
+    if (engine->bestScore >= MATE_BOUND || engine->bestScore <= -MATE_BOUND) {
+      return engine_finish(engine);
+    }
+    if (now - engine->startUs >= time_soft_deadline(&engine->budget, engine->instability)) {
+      return engine_finish(engine);
+    }
+  }
+}
+
+/**
+ * @brief Searches the current position until a limit is reached.
+ *
+ * @param engine Pointer to the engine.
+ * @param game Pointer to the game.
+ * @return The best move found, or NO_MOVE if the side to move has no legal move.
+ */
+uint16_t engine_best_move(struct Engine *engine, struct Game *game) {
+  engine->thinking = false;
+  while (!engine_think(engine, game, engine->limits.timeUs, 0)) {
+  }
+  return engine->bestMove;
+}
@@ -0,0 +1,154 @@
+/**
+ * @file search.h
+ * @brief Header file containing the computer opponent: an iterative deepening alpha-beta search.
+ *
+ * The search is a negamax alpha-beta over make_move/unmake_move, deepened one ply at a time
+ * until the depth, node or time limit of the strength level is reached. It runs in slices:
+ * engine_think searches for a bounded time and returns, so the interrupt loop keeps serving the
+ * keyboard, the mouse and the clocks while the computer thinks. The next call goes on with the
+ * current iteration from the root move the last one stopped in, which is searched again from
+ * its start: only the transposition table keeps the work done on it, so slices short next to
+ * the time of a root move need a table to get anywhere.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../game.h"
+#include "tt.h"
+#include "pawns.h"
+#include "timeman.h"
+
+/** @brief Score of a checkmate; a mate in n plies scores MATE_SCORE - n. */
+#define MATE_SCORE 30000
+
+/** @brief Score bound larger than any real score. */
+#define INFINITE_SCORE 32000
+
+/** @brief Scores beyond this value are mates. */
+#define MATE_BOUND (MATE_SCORE - MAX_PLIES)
+
+/** @brief Most the evaluation moves the score of a position the tablebases know is won. */
+#define TB_EVAL_MARGIN 1000
+
+/** @brief Score of a position the tablebases know is won, before the evaluation and the distance from the root are added; below any mate. */
+#define TB_WIN_SCORE (MATE_BOUND - TB_EVAL_MARGIN - 1)
+
+/** @brief Number of strength levels; level 0 means no computer player. */
+#define ENGINE_LEVELS 5
+
+/** @brief Deepest ply the per-ply search tables (killer moves, statistics) cover. */
+#define MAX_SEARCH_PLY 64
+
+/**
+ * @brief Structure representing the limits of one search.
+ */
+struct SearchLimits {
+  int depth;       /**< deepest iteration */
+  uint64_t nodes;  /**< nodes after which the search stops */
+  uint64_t timeUs; /**< thinking time after which the search stops, in microseconds */
+};
+
+/**
+ * @brief Structure representing the search techniques an engine uses, each of which can be turned off to measure what it brings.
+ */
+struct SearchOptions {
+  bool hashMove;  /**< search the move of the transposition table first */
+  bool mvvLva;    /**< order captures by most valuable victim, then least valuable attacker */
+  bool killers;   /**< search the quiet moves that caused cutoffs at the same ply early */
+  bool history;   /**< order the other quiet moves by how often they caused cutoffs */
+  bool nullMove;  /**< prune positions that stay above beta even after passing the turn */
+  bool lmr;       /**< search late quiet moves to a reduced depth first */
+  bool pvs;       /**< search the moves after the first with a null window first */
+  bool see;       /**< skip the captures that lose material in the quiescence search, and search them last elsewhere */
+  bool pawnTable; /**< reuse the evaluation of the pawn structures already met */
+  bool tablebases; /**< look the endings with few pieces up instead of searching them */
+};
+
+/**
+ * @brief Structure representing the computer player and the state of its current search.
+ */
+struct Engine {
+  int level;                    /**< strength level, 1 to ENGINE_LEVELS */
+  struct SearchLimits limits;   /**< limits of the level */
+  struct TTable *tt;            /**< transposition table, possibly shared with other engines, or NULL */
+  struct SearchOptions options; /**< search techniques in use */
+  int startDepth;               /**< depth of the first iteration, 1 unless the engine helps a parallel search */
+  bool *abort;                  /**< flag another thread sets to end the search, or NULL */
+  bool agesTable;               /**< whether starting a search ages the transposition table; the caller of a parallel search ages it once for all the threads */
+  const struct Clock *clock;    /**< clock of the side to move, read when a search starts, or NULL to take the time of the level */
+
+  bool thinking;                /**< whether a search is in progress */
+  uint64_t rootHash;            /**< hash of the position being searched */
+  int rootPly;                  /**< undoIndex of the position being searched */
+  struct MoveBuffer rootMoves;  /**< legal moves of the root, best first */
+  int rootIndex;                /**< next root move to search in the current iteration */
+  int depth;                    /**< depth of the current iteration */
+  int alpha;                    /**< best score of the current iteration so far */
+  uint16_t iterationMove;       /**< best move of the current iteration so far */
+
+  uint16_t bestMove;            /**< best move of the last completed iteration */
+  int bestScore;                /**< score of bestMove */
+  int completedDepth;           /**< depth of the last completed iteration */
+
+  uint64_t nodes;               /**< nodes searched since the search started */
+  uint64_t startUs;             /**< time the search started */
+  struct TimeBudget budget;     /**< time the search may take */
+  int instability;              /**< how much the best move changed in the last iterations */
+  uint64_t stopUs;              /**< time the current slice must stop */
+  uint64_t sliceStartNodes;     /**< value of nodes when the current slice started */
+  uint64_t stopNodes;           /**< value of nodes at which the current slice must stop */
+  bool stopped;                 /**< whether the current slice was interrupted */
+
+  uint16_t killers[MAX_SEARCH_PLY][2]; /**< last two quiet moves that caused a cutoff, per ply */
+  int history[2][64][64];              /**< cutoff score of the quiet moves, per color, origin and destination */
+  uint64_t depthNodes[MAX_SEARCH_PLY + 1]; /**< nodes searched when each iteration completed */
+  uint64_t depthUs[MAX_SEARCH_PLY + 1];    /**< time elapsed when each iteration completed */
+  struct PawnTable pawns;                  /**< pawn structures evaluated by this engine */
+};
+
+/**
+ * @brief Search options with every technique turned on.
+ */
+extern const struct SearchOptions search_default_options;
+
+/**
+ * @brief Search limits of each strength level, from level 1.
+ */
+extern const struct SearchLimits engine_levels[ENGINE_LEVELS];
+
+/**
+ * @brief Initializes a computer player.
+ *
+ * @param engine Pointer to the engine.
+ * @param level Strength level, clamped to 1..ENGINE_LEVELS.
+ * @param tt Transposition table to search with, or NULL.
+ */
+void engine_init(struct Engine *engine, int level, struct TTable *tt);
+
+/**
+ * @brief Searches the current position for at most a slice of time and nodes.
+ *
+ * A search starts on the first call for a position and resumes on the following ones; the
+ * game must be in the same position between calls, and is left in it. The position may be one
+ * where the opponent is to move, to ponder on its time: the transposition table then already
+ * holds the replies to its move when the computer's turn comes.
+ *
+ * @param engine Pointer to the engine.
+ * @param game Pointer to the game.
+ * @param sliceUs Longest time to search before returning, in microseconds.
+ * @param sliceNodes Most nodes to search before returning, or 0 for no bound.
+ * @return true if the search is over and engine->bestMove holds the move to play (NO_MOVE if there is none), false otherwise.
+ */
+bool engine_think(struct Engine *engine, struct Game *game, uint64_t sliceUs, uint64_t sliceNodes);
+
+/**
+ * @brief Searches the current position until a limit is reached.
+ *
+ * @param engine Pointer to the engine.
+ * @param game Pointer to the game.
+ * @return The best move found, or NO_MOVE if the side to move has no legal move.
+ */
+uint16_t engine_best_move(struct Engine *engine, struct Game *game);
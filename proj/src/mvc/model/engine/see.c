@@ -0,0 +1,148 @@
+/**
+ * @file see.c
+ * @brief Implementation of the static exchange evaluator.
+ *
+ * The attackers of the square are found with attackers_to on an occupancy from which each
+ * piece that captured is removed, so sliders lined up behind it join the exchange in turn.
+ */
+
+#include "see.h"
+#include "../movegen/movegen.h"
+
+const int see_values[6] = {100, 500, 320, 330, 900, 20000};
+
+/** @brief Order in which the pieces of a side recapture, least valuable first. */
+static const enum PieceType recapture_order[6] = {PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING};
+
+/**
+ * @brief Plays out the captures on a square after a first piece moved to it.
+ *
+ * This function records, for each capture, the material balance if the exchange stopped right after it, then folds the list from
+ * the end, each side choosing between capturing and standing pat. A king only recaptures when the other side has no attacker
+ * left.
+ *
+ * @param bb Pointer to the position.
+ * @param to Square of the exchange.
+ * @param from Square the first piece comes from.
+ * @param piece Type of the first piece once on the square.
+ * @param captured Material the first move wins.
+ * @param occupied Occupancy before the first move, without any piece it captures en passant.
+ * @param white Whether the first piece is white.
+ * @return Material the side of the first piece wins by the exchange.
+ */
+static int swap(const struct Bitboard *bb, int to, int from, enum PieceType piece, int captured, uint64_t occupied, bool white) {
+  int gain[34];
+  int d = 0;
+
+  gain[0] = captured;
+  for (;;) {
+    d++;
+    gain[d] = see_values[piece] - gain[d - 1];
+    occupied &= ~SQUARE_BIT(from);
+    uint64_t attackers = attackers_to(bb, to, occupied) & occupied;
+    white = !white;
+
+    uint64_t mine = attackers & bb->colors[COLOR(white)];
+    if (mine == 0) {
+      break;
+    }
+
+    int i = 0;
+    while (!(mine & bb->pieces[COLOR(white)][recapture_order[i]])) {
+      i++;
+    }
+    piece = recapture_order[i];
+    if (piece == KING && (attackers & bb->colors[COLOR(!white)])) {
+      break;
+    }
+    from = bitboard_lsb(mine & bb->pieces[COLOR(white)][piece]);
+  }
+
+  while (--d) {
+    gain[d - 1] = -(-gain[d - 1] > gain[d] ? -gain[d - 1] : gain[d]);
+  }
+  return gain[0];
+}
+
+/**
+ * @brief Evaluates the exchange started by a move.
+ *
+ * A quiet move scores the loss of the moved piece if it can be taken with profit, so the function also tells whether a square is
+ * safe to move to. Promotions count the promoted piece, and castling always scores 0.
+ *
+ * @param bb Pointer to the position, the move being one of the side to move.
+ * @param move Encoded pseudo-legal move.
+ * @return Material the side to move wins by the exchange (negative if it loses), in centipawns.
+ */
+int see(const struct Bitboard *bb, uint16_t move) {
+  int from = MOVE_FROM(move);
+  int to = MOVE_TO(move);
+  int flags = MOVE_FLAGS(move);
+  uint64_t occupied = bb->occupied;
+  enum PieceType piece;
+  enum PieceType victim;
+  bool white;
+  bool victimWhite;
+  int captured = 0;
+
+  if (flags == MOVE_KING_CASTLE || flags == MOVE_QUEEN_CASTLE || !bitboard_piece_at(bb, from, &piece, &white)) {
+    return 0;
+  }
+
+  if (flags == MOVE_EP_CAPTURE) {
+    captured = see_values[PAWN];
+    occupied &= ~SQUARE_BIT(white ? to - 8 : to + 8);
+  }
+  else if (MOVE_IS_CAPTURE(move) && bitboard_piece_at(bb, to, &victim, &victimWhite)) {
+    captured = see_values[victim];
+  }
+
+  if (MOVE_IS_PROMOTION(move)) {
+    piece = move_promotion(move);
+    captured += see_values[piece] - see_values[PAWN];
+  }
+  return swap(bb, to, from, piece, captured, occupied, white);
+}
+
+/**
+ * @brief Evaluates the best exchange one side can start on a square.
+ *
+ * This function starts the exchange with the least valuable attacker, which is the best first capture in all but rare cases.
+ *
+ * @param bb Pointer to the position.
+ * @param sq Square of the piece to be captured.
+ * @param byWhite Whether the capturing side is white.
+ * @return Material the capturing side wins by capturing first, or 0 if it cannot win any.
+ */
+int see_square(const struct Bitboard *bb, int sq, bool byWhite) {
+  enum PieceType victim;
+  bool victimWhite;
+
+  if (!bitboard_piece_at(bb, sq, &victim, &victimWhite) || victimWhite == byWhite) {
+    return 0;
+  }
+
+  uint64_t attackers = attackers_to(bb, sq, bb->occupied) & bb->colors[COLOR(byWhite)];
+  for (int i = 0; i < 6; i++) {
+    uint64_t pieces = attackers & bb->pieces[COLOR(byWhite)][recapture_order[i]];
+    if (pieces) {
+      int gain = swap(bb, sq, bitboard_lsb(pieces), recapture_order[i], see_values[victim], bb->occupied, byWhite);
+      return gain > 0 ? gain : 0;
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief Checks if a piece can be won by its opponent through captures on its square.
+ *
+ * @param bb Pointer to the position.
+ * @param sq Square of the piece.
+ * @return true if there is a piece on the square and its opponent wins material by capturing it, false otherwise.
+ */
+bool is_piece_hanging(const struct Bitboard *bb, int sq) {
+  enum PieceType type;
+  bool isWhite;
+
+  return bitboard_piece_at(bb, sq, &type, &isWhite) && type != KING && see_square(bb, sq, !isWhite) > 0;
+}
@@ -0,0 +1,52 @@
+/**
+ * @file see.h
+ * @brief Header file containing the static exchange evaluator.
+ *
+ * Static exchange evaluation plays out, without making any move, the sequence of captures on
+ * one square in which each side recaptures with its least valuable piece and may stop whenever
+ * going on would lose material. The result tells whether a capture wins, trades or loses
+ * material, which the search uses to skip losing captures and to order the others, and whether
+ * a piece is left hanging.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../bitboard/bitboard.h"
+
+/**
+ * @brief Values of the pieces in exchanges (PAWN to KING), in centipawns.
+ */
+extern const int see_values[6];
+
+/**
+ * @brief Evaluates the exchange started by a move.
+ *
+ * @param bb Pointer to the position, the move being one of the side to move.
+ * @param move Encoded pseudo-legal move.
+ * @return Material the side to move wins by the exchange (negative if it loses), in centipawns.
+ */
+int see(const struct Bitboard *bb, uint16_t move);
+
+/**
+ * @brief Evaluates the best exchange one side can start on a square.
+ *
+ * @param bb Pointer to the position.
+ * @param sq Square of the piece to be captured.
+ * @param byWhite Whether the capturing side is white.
+ * @return Material the capturing side wins by capturing first, or 0 if it cannot win any.
+ */
+int see_square(const struct Bitboard *bb, int sq, bool byWhite);
+
+/**
+ * @brief Checks if a piece can be won by its opponent through captures on its square.
+ *
+ * Pins are not taken into account, as in the rest of the exchange evaluation.
+ *
+ * @param bb Pointer to the position.
+ * @param sq Square of the piece.
+ * @return true if there is a piece on the square and its opponent wins material by capturing it, false otherwise.
+ */
+bool is_piece_hanging(const struct Bitboard *bb, int sq);
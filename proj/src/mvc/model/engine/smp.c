@@ -0,0 +1,114 @@
+/**
+ * @file smp.c
+ * @brief Implementation of the parallel search (Lazy SMP) of the Linux host build.
+ *
+ * Each helper thread owns an engine, for its killer moves, history and pawn table, and a copy
+ * of the game to make its moves on; only the transposition table is shared, and it needs no
+ * locks. The main thread searches with the caller's engine and raises the abort flag of the
+ * helpers when it is done.
+ */
+
+#include <stdlib.h>
+
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+#include "smp.h"
+
+/**
+ * @brief Structure representing one helper thread of a parallel search.
+ */
+struct SmpHelper {
+  struct Engine engine; /**< engine of the helper */
+  struct Game *game;    /**< copy of the game the helper searches */
+#ifdef __linux__
+  pthread_t thread;     /**< the thread */
+#endif
+};
+
+#ifdef __linux__
+/**
+ * @brief Runs the search of a helper until it is aborted.
+ *
+ * @param arg Pointer to the SmpHelper.
+ * @return NULL.
+ */
+static void *smp_helper(void *arg) {
+  struct SmpHelper *helper = (struct SmpHelper *) arg;
+  engine_best_move(&helper->engine, helper->game);
+  return NULL;
+}
+#endif
+
+/**
+ * @brief Searches the current position with several threads until the main thread reaches a limit.
+ *
+ * This function ages the transposition table once for the whole search, sets up the helpers with the level and options of
+ * the main engine but no depth limit, starts them, runs the main search on the calling thread, then aborts and joins the
+ * helpers. Helpers that cannot be allocated or started are simply left out.
+ *
+ * @param engine Pointer to the main engine, whose level, options and transposition table the helpers share; it must have a table.
+ * @param game Pointer to the game; it is left in the position it was given in.
+ * @param threads Number of threads, the calling thread included; clamped to 1..SMP_MAX_THREADS.
+ * @param nodes Filled with the nodes searched by all the threads, or NULL.
+ * @return The best move found by the main thread, or NO_MOVE if the side to move has no legal move.
+ */
+uint16_t smp_best_move(struct Engine *engine, struct Game *game, int threads, uint64_t *nodes) {
+  // aged by every thread, the table would count the entries of this search as those of older ones
+  bool agesTable = engine->agesTable;
+  tt_new_search(engine->tt);
+  engine->agesTable = false;
+
+#ifdef __linux__
+  bool abort = false;
+  int started = 0;
+
+  if (threads > SMP_MAX_THREADS) {
+    threads = SMP_MAX_THREADS;
+  }
+  struct SmpHelper *helpers = threads > 1 ? (struct SmpHelper *) malloc((threads - 1) * sizeof(struct SmpHelper)) : NULL;
+
+  for (; helpers != NULL && started < threads - 1; started++) {
+    struct SmpHelper *helper = &helpers[started];
+    helper->game = create_game();
+    if (helper->game == NULL) {
+      break;
+    }
+    *helper->game = *game;
+
+    engine_init(&helper->engine, engine->level, engine->tt);
+    helper->engine.options = engine->options;
+    helper->engine.limits = engine->limits;
+    helper->engine.limits.depth = MAX_SEARCH_PLY;
+    helper->engine.startDepth = 1 + (started + 1) % 2;
+    helper->engine.abort = &abort;
+    helper->engine.agesTable = false;
+    if (pthread_create(&helper->thread, NULL, smp_helper, helper) != 0) {
+      destroy_game(helper->game);
+      break;
+    }
+  }
+#else
+  (void) threads;
+#endif
+
+  uint16_t move = engine_best_move(engine, game);
+  uint64_t total = engine->nodes;
+  engine->agesTable = agesTable;
+
+#ifdef __linux__
+  __atomic_store_n(&abort, true, __ATOMIC_RELAXED);
+  for (int i = 0; i < started; i++) {
+    pthread_join(helpers[i].thread, NULL);
+    total += helpers[i].engine.nodes;
+    destroy_game(helpers[i].game);
+  }
+  free(helpers);
+#endif
+
+  if (nodes != NULL) {
+    *nodes = total;
+  }
+  return move;
+}
@@ -0,0 +1,31 @@
+/**
+ * @file smp.h
+ * @brief Header file containing the parallel search (Lazy SMP) of the Linux host build.
+ *
+ * Lazy SMP runs the ordinary search on several threads at once, all from the same root and
+ * all sharing the transposition table. The threads do not split the tree: they race through it,
+ * and what one of them stores in the table saves the others the work. Half of the helpers start
+ * one ply deeper, so the threads soon search different depths and their move orders diverge.
+ * Only the main thread's result is played. Under Minix, which has no threads, the main thread
+ * searches alone.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "search.h"
+
+/** @brief Largest number of threads of a parallel search. */
+#define SMP_MAX_THREADS 64
+
+/**
+ * @brief Searches the current position with several threads until the main thread reaches a limit.
+ *
+ * @param engine Pointer to the main engine, whose level, options and transposition table the helpers share; it must have a table.
+ * @param game Pointer to the game; it is left in the position it was given in.
+ * @param threads Number of threads, the calling thread included; clamped to 1..SMP_MAX_THREADS.
+ * @param nodes Filled with the nodes searched by all the threads, or NULL.
+ * @return The best move found by the main thread, or NO_MOVE if the side to move has no legal move.
+ */
+uint16_t smp_best_move(struct Engine *engine, struct Game *game, int threads, uint64_t *nodes);
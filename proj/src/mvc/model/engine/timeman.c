@@ -0,0 +1,64 @@
+/**
+ * @file timeman.c
+ * @brief Implementation of the time management of the computer player.
+ */
+
+#include "timeman.h"
+
+/**
+ * @brief Converts a clock to the time it shows.
+ *
+ * @param clock Pointer to the clock.
+ * @return The time left on the clock, in microseconds, 0 if it shows a negative time.
+ */
+uint64_t clock_remaining_us(const struct Clock *clock) {
+  int64_t tenths = ((((int64_t) clock->days * 24 + clock->hours) * 60 + clock->minutes) * 60 + clock->seconds) * 10 + clock->a_tenth_of_a_second;
+  return tenths > 0 ? (uint64_t) tenths * 100000 : 0;
+}
+
+/**
+ * @brief Computes the time budget of a move.
+ *
+ * This function keeps TM_OVERHEAD_US on the clock and expects the game to last TM_MOVES_LEFT more moves at the start, one fewer every two moves down to TM_MIN_MOVES_LEFT. The soft time is the share of one of those moves; the hard time is TM_HARD_FACTOR soft times, but never more than a TM_MAX_SHARE-th of the usable time.
+ *
+ * @param clock Pointer to the clock of the side to move.
+ * @param fullmoveNumber Number of the move, starting at 1.
+ * @param maxUs Longest time the move may take whatever the clock shows, in microseconds.
+ * @param budget Filled with the budget.
+ */
+void time_budget(const struct Clock *clock, int fullmoveNumber, uint64_t maxUs, struct TimeBudget *budget) {
+  uint64_t remaining = clock_remaining_us(clock);
+  uint64_t usable = remaining > TM_OVERHEAD_US ? remaining - TM_OVERHEAD_US : 0;
+
+  int movesLeft = TM_MOVES_LEFT - (fullmoveNumber - 1) / 2;
+  if (movesLeft < TM_MIN_MOVES_LEFT) {
+    movesLeft = TM_MIN_MOVES_LEFT;
+  }
+
+  uint64_t soft = usable / movesLeft;
+  uint64_t hard = soft * TM_HARD_FACTOR;
+  if (hard > usable / TM_MAX_SHARE) {
+    hard = usable / TM_MAX_SHARE;
+  }
+  if (hard > maxUs) {
+    hard = maxUs;
+  }
+  if (soft > hard) {
+    soft = hard;
+  }
+
+  budget->softUs = soft;
+  budget->hardUs = hard;
+}
+
+/**
+ * @brief Computes the time after which no new iteration should start.
+ *
+ * @param budget Pointer to the budget of the move.
+ * @param instability How much the best move changed in the last iterations, 0 if it did not; each TM_INSTABILITY_UNIT adds the soft time once more.
+ * @return The deadline, relative to the start of the search, in microseconds.
+ */
+uint64_t time_soft_deadline(const struct TimeBudget *budget, int instability) {
+  uint64_t deadline = budget->softUs + budget->softUs * instability / TM_INSTABILITY_UNIT;
+  return deadline < budget->hardUs ? deadline : budget->hardUs;
+}
@@ -0,0 +1,70 @@
+/**
+ * @file timeman.h
+ * @brief Header file containing the time management of the computer player.
+ *
+ * Under a time control the time of a move comes from the clock of the side to move: the
+ * remaining time is shared among the moves the game is still expected to last. The clocks of the
+ * game have no increment, so nothing is added back after a move. The search gets two deadlines
+ * from it. The soft one is checked between iterations, and is stretched while the best move keeps
+ * changing; the hard one ends the search wherever it is, and is kept within a share of the time
+ * left on the clock so that the computer never flags.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "../game.h"
+
+/** @brief Time kept on the clock for the delays of the interrupt loop, in microseconds. */
+#define TM_OVERHEAD_US 200000
+
+/** @brief Moves a game is expected to last after the first one. */
+#define TM_MOVES_LEFT 40
+
+/** @brief Fewest moves a game is expected to last, however long it already is. */
+#define TM_MIN_MOVES_LEFT 15
+
+/** @brief Most the hard deadline may exceed the soft one, as a factor. */
+#define TM_HARD_FACTOR 4
+
+/** @brief Largest share of the remaining time a single move may take, as a divisor. */
+#define TM_MAX_SHARE 5
+
+/** @brief Instability recorded for an iteration whose best move differs from the previous one. */
+#define TM_INSTABILITY_UNIT 4
+
+/**
+ * @brief Structure representing the time a search may take.
+ */
+struct TimeBudget {
+  uint64_t softUs; /**< time after which no new iteration starts, before any extension */
+  uint64_t hardUs; /**< time after which the search stops */
+};
+
+/**
+ * @brief Converts a clock to the time it shows.
+ *
+ * @param clock Pointer to the clock.
+ * @return The time left on the clock, in microseconds, 0 if it shows a negative time.
+ */
+uint64_t clock_remaining_us(const struct Clock *clock);
+
+/**
+ * @brief Computes the time budget of a move.
+ *
+ * @param clock Pointer to the clock of the side to move.
+ * @param fullmoveNumber Number of the move, starting at 1.
+ * @param maxUs Longest time the move may take whatever the clock shows, in microseconds.
+ * @param budget Filled with the budget.
+ */
+void time_budget(const struct Clock *clock, int fullmoveNumber, uint64_t maxUs, struct TimeBudget *budget);
+
+/**
+ * @brief Computes the time after which no new iteration should start.
+ *
+ * @param budget Pointer to the budget of the move.
+ * @param instability How much the best move changed in the last iterations, 0 if it did not; each TM_INSTABILITY_UNIT adds the soft time once more.
+ * @return The deadline, relative to the start of the search, in microseconds.
+ */
+uint64_t time_soft_deadline(const struct TimeBudget *budget, int instability);
@@ -0,0 +1,224 @@
+/**
+ * @file tt.c
+ * @brief Implementation of the transposition table shared by the searches.
+ *
+ * On the Linux host build the table is mapped with huge pages when the system has some to
+ * give, which saves most of the TLB misses of random probes into a large table; otherwise, and
+ * under Minix, it comes from the heap, aligned to a cache line by hand.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#include "tt.h"
+#include "search.h"
+
+#define TT_MOVE_SHIFT 0   /**< @brief Position of the move in the data word */
+#define TT_SCORE_SHIFT 16 /**< @brief Position of the score in the data word */
+#define TT_DEPTH_SHIFT 32 /**< @brief Position of the depth in the data word */
+#define TT_BOUND_SHIFT 40 /**< @brief Position of the bound in the data word */
+#define TT_AGE_SHIFT 48   /**< @brief Position of the age in the data word */
+
+/**
+ * @brief Allocates the memory of a table, with huge pages if possible.
+ *
+ * @param table Pointer to the table, whose bytes field gives the size.
+ * @return 0 upon success, 1 otherwise.
+ */
+static int tt_allocate(struct TTable *table) {
+  table->mapped = false;
+  table->hugePages = false;
+
+#ifdef __linux__
+#ifdef MAP_HUGETLB
+  table->memory = mmap(NULL, table->bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (table->memory != MAP_FAILED) {
+    table->mapped = true;
+    table->hugePages = true;
+    table->buckets = (struct TTBucket *) table->memory;
+    return 0;
+  }
+#endif
+  table->memory = mmap(NULL, table->bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (table->memory != MAP_FAILED) {
+    table->mapped = true;
+#ifdef MADV_HUGEPAGE
+    // transparent huge pages, when the kernel has them enabled for madvise'd memory
+    table->hugePages = madvise(table->memory, table->bytes, MADV_HUGEPAGE) == 0;
+#endif
+    table->buckets = (struct TTBucket *) table->memory;
+    return 0;
+  }
+#endif
+
+  table->memory = calloc(1, table->bytes + sizeof(struct TTBucket));
+  if (table->memory == NULL) {
+    return 1;
+  }
+  table->buckets = (struct TTBucket *) (((uintptr_t) table->memory + sizeof(struct TTBucket) - 1) & ~(uintptr_t) (sizeof(struct TTBucket) - 1));
+  return 0;
+}
+
+/**
+ * @brief Allocates a transposition table.
+ *
+ * @param table Pointer to the table to be set up.
+ * @param megabytes Size of the table; rounded down to a power of two number of buckets.
+ * @return 0 upon success, 1 if the memory could not be allocated.
+ */
+int tt_create(struct TTable *table, unsigned megabytes) {
+  uint64_t bytes = (uint64_t) megabytes << 20;
+  uint64_t count = 1;
+
+  while (count * 2 * sizeof(struct TTBucket) <= bytes) {
+    count *= 2;
+  }
+
+  table->bytes = count * sizeof(struct TTBucket);
+  table->mask = count - 1;
+  table->age = 0;
+  if (tt_allocate(table) != 0) {
+    table->buckets = NULL;
+    table->mask = 0;
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Frees the memory of a transposition table.
+ *
+ * @param table Pointer to the table.
+ */
+void tt_destroy(struct TTable *table) {
+#ifdef __linux__
+  if (table->mapped) {
+    munmap(table->memory, table->bytes);
+  }
+  else
+#endif
+  {
+    free(table->memory);
+  }
+  table->memory = NULL;
+  table->buckets = NULL;
+  table->mask = 0;
+}
+
+/**
+ * @brief Empties a transposition table.
+ *
+ * @param table Pointer to the table.
+ */
+void tt_clear(struct TTable *table) {
+  memset(table->buckets, 0, table->bytes);
+  table->age = 0;
+}
+
+/**
+ * @brief Starts a new search, so the entries of the older ones are replaced first.
+ *
+ * @param table Pointer to the table.
+ */
+void tt_new_search(struct TTable *table) {
+  table->age++;
+}
+
+/**
+ * @brief Looks a position up.
+ *
+ * This function reads each entry of the bucket of the hash and accepts the one whose check word matches the hash once XOR-ed with its data.
+ *
+ * @param table Pointer to the table.
+ * @param hash Zobrist hash of the position.
+ * @param ply Distance of the position from the root, to turn stored mate scores back into distances from the root.
+ * @param entry Filled with the entry on a hit.
+ * @return true on a hit, false otherwise.
+ */
+bool tt_probe(const struct TTable *table, uint64_t hash, int ply, struct TTEntry *entry) {
+  const struct TTBucket *bucket = &table->buckets[hash & table->mask];
+
+  for (int i = 0; i < TT_BUCKET_SIZE; i++) {
+    uint64_t data = __atomic_load_n(&bucket->slots[i].data, __ATOMIC_RELAXED);
+    uint64_t check = __atomic_load_n(&bucket->slots[i].check, __ATOMIC_RELAXED);
+
+    if ((check ^ data) != hash || data == 0) {
+      continue;
+    }
+
+    int score = (int16_t) (data >> TT_SCORE_SHIFT);
+    if (score >= MATE_BOUND) {
+      score -= ply;
+    }
+    else if (score <= -MATE_BOUND) {
+      score += ply;
+    }
+
+    entry->move = (uint16_t) (data >> TT_MOVE_SHIFT);
+    entry->score = score;
+    entry->depth = (uint8_t) (data >> TT_DEPTH_SHIFT);
+    entry->bound = (enum TTBound) ((data >> TT_BOUND_SHIFT) & 0x3);
+    return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Stores the result of the search of a position.
+ *
+ * This function overwrites the entry of the same position if the bucket has one. Otherwise it replaces the entry that is worth the least: empty entries first, then the shallowest ones, each search of age counting as four plies of depth. A move is never lost to an entry of the same position stored without one.
+ *
+ * @param table Pointer to the table.
+ * @param hash Zobrist hash of the position.
+ * @param ply Distance of the position from the root, to store mate scores as distances from the position.
+ * @param depth Depth of the search.
+ * @param bound Meaning of the score.
+ * @param score Score of the search.
+ * @param move Best move found, or NO_MOVE.
+ */
+void tt_store(struct TTable *table, uint64_t hash, int ply, int depth, enum TTBound bound, int score, uint16_t move) {
+  struct TTBucket *bucket = &table->buckets[hash & table->mask];
+  struct TTSlot *victim = &bucket->slots[0];
+  int victimWorth = INFINITE_SCORE;
+
+  for (int i = 0; i < TT_BUCKET_SIZE; i++) {
+    struct TTSlot *slot = &bucket->slots[i];
+    uint64_t data = __atomic_load_n(&slot->data, __ATOMIC_RELAXED);
+    uint64_t check = __atomic_load_n(&slot->check, __ATOMIC_RELAXED);
+
+    if (data != 0 && (check ^ data) == hash) {
+      if (move == NO_MOVE) {
+        move = (uint16_t) (data >> TT_MOVE_SHIFT);
+      }
+      victim = slot;
+      break;
+    }
+
+    int worth = -INFINITE_SCORE;
+    if (data != 0) {
+      uint8_t age = (uint8_t) (table->age - (uint8_t) (data >> TT_AGE_SHIFT));
+      worth = (int) (uint8_t) (data >> TT_DEPTH_SHIFT) - 4 * age;
+    }
+    if (worth < victimWorth) {
+      victimWorth = worth;
+      victim = slot;
+    }
+  }
+
+  if (score >= MATE_BOUND) {
+    score += ply;
+  }
+  else if (score <= -MATE_BOUND) {
+    score -= ply;
+  }
+
+  uint64_t data = (uint64_t) move << TT_MOVE_SHIFT | (uint64_t) (uint16_t) score << TT_SCORE_SHIFT |
+                  (uint64_t) (uint8_t) depth << TT_DEPTH_SHIFT | (uint64_t) bound << TT_BOUND_SHIFT |
+                  (uint64_t) table->age << TT_AGE_SHIFT;
+  __atomic_store_n(&victim->data, data, __ATOMIC_RELAXED);
+  __atomic_store_n(&victim->check, hash ^ data, __ATOMIC_RELAXED);
+}
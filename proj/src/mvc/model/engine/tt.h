@@ -0,0 +1,124 @@
+/**
+ * @file tt.h
+ * @brief Header file containing the transposition table shared by the searches.
+ *
+ * The table remembers, per position hash, the depth, score, bound and best move of the last
+ * search of the position. It is split into buckets of four entries that fill one 64-byte cache
+ * line, so a probe touches a single line. Entries are two 64-bit words, the data and the hash
+ * XOR-ed with the data, so the table needs no locks: a read that mixes two concurrent writes
+ * fails the check and counts as a miss.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** @brief Default size of the table in megabytes. */
+#define TT_DEFAULT_MB 16
+
+/** @brief Number of entries in a bucket. */
+#define TT_BUCKET_SIZE 4
+
+/**
+ * @brief Enum representing what the score of an entry says about the real score.
+ */
+enum TTBound {
+  TT_NONE = 0,  /**< empty entry */
+  TT_UPPER = 1, /**< the search failed low: the real score is at most the stored one */
+  TT_LOWER = 2, /**< the search failed high: the real score is at least the stored one */
+  TT_EXACT = 3  /**< the stored score is exact */
+};
+
+/**
+ * @brief Structure representing one stored entry, as packed in the table.
+ */
+struct TTSlot {
+  uint64_t check; /**< position hash XOR-ed with data */
+  uint64_t data;  /**< move, score, depth, bound and age, packed */
+};
+
+/**
+ * @brief Structure representing a bucket: one cache line of entries.
+ */
+struct TTBucket {
+  struct TTSlot slots[TT_BUCKET_SIZE]; /**< entries of the bucket */
+} __attribute__((aligned(64)));
+
+/**
+ * @brief Structure representing the result of a probe.
+ */
+struct TTEntry {
+  uint16_t move;      /**< best move, or NO_MOVE */
+  int score;          /**< score, mate scores relative to the probed position */
+  int depth;          /**< depth of the search that stored the entry */
+  enum TTBound bound; /**< meaning of the score */
+};
+
+/**
+ * @brief Structure representing the transposition table.
+ */
+struct TTable {
+  struct TTBucket *buckets; /**< buckets, a power of two of them */
+  uint64_t mask;            /**< number of buckets minus one */
+  size_t bytes;             /**< size of the allocation */
+  void *memory;             /**< start of the allocation, buckets rounded up to a cache line from it */
+  bool mapped;              /**< whether the memory was mapped rather than allocated */
+  bool hugePages;           /**< whether the memory is backed by huge pages */
+  uint8_t age;              /**< age of the current search, stamped on the entries it stores */
+};
+
+/**
+ * @brief Allocates a transposition table.
+ *
+ * @param table Pointer to the table to be set up.
+ * @param megabytes Size of the table; rounded down to a power of two number of buckets.
+ * @return 0 upon success, 1 if the memory could not be allocated.
+ */
+int tt_create(struct TTable *table, unsigned megabytes);
+
+/**
+ * @brief Frees the memory of a transposition table.
+ *
+ * @param table Pointer to the table.
+ */
+void tt_destroy(struct TTable *table);
+
+/**
+ * @brief Empties a transposition table.
+ *
+ * @param table Pointer to the table.
+ */
+void tt_clear(struct TTable *table);
+
+/**
+ * @brief Starts a new search, so the entries of the older ones are replaced first.
+ *
+ * @param table Pointer to the table.
+ */
+void tt_new_search(struct TTable *table);
+
+/**
+ * @brief Looks a position up.
+ *
+ * @param table Pointer to the table.
+ * @param hash Zobrist hash of the position.
+ * @param ply Distance of the position from the root, to turn stored mate scores back into distances from the root.
+ * @param entry Filled with the entry on a hit.
+ * @return true on a hit, false otherwise.
+ */
+bool tt_probe(const struct TTable *table, uint64_t hash, int ply, struct TTEntry *entry);
+
+/**
+ * @brief Stores the result of the search of a position.
+ *
+ * @param table Pointer to the table.
+ * @param hash Zobrist hash of the position.
+ * @param ply Distance of the position from the root, to store mate scores as distances from the position.
+ * @param depth Depth of the search.
+ * @param bound Meaning of the score.
+ * @param score Score of the search.
+ * @param move Best move found, or NO_MOVE.
+ */
+void tt_store(struct TTable *table, uint64_t hash, int ply, int depth, enum TTBound bound, int score, uint16_t move);
@@ -0,0 +1,393 @@
+/**
+ * @file fen.c
+ * @brief Implementation of the FEN (Forsyth-Edwards Notation) reader and writer.
+ *
+ * The reader builds the position on a local bitboard, checks it, and only then fills the game,
+ * so a rejected record never leaves a game half loaded.
+ */
+
+#include <string.h>
+
+#include "fen.h"
+#include "../engine/evaluate.h"
+
+/** @brief FEN letter of each piece type (PAWN to KING), lowercase. */
+static const char piece_letters[6] = {'p', 'r', 'n', 'b', 'q', 'k'};
+
+/**
+ * @brief Structure describing the king and rook squares one castling right depends on.
+ */
+struct CastlingSquares {
+  uint8_t right;  /**< CASTLING_* flag */
+  bool isWhite;   /**< color of the right */
+  int8_t king;    /**< initial square of the king */
+  int8_t rook;    /**< initial square of the rook */
+  char letter;    /**< FEN letter of the right */
+};
+
+/** @brief The four castling rights, in FEN order. */
+static const struct CastlingSquares castling_squares[4] = {
+  {CASTLING_WHITE_SHORT, true, SQUARE(4, 0), SQUARE(7, 0), 'K'},
+  {CASTLING_WHITE_LONG, true, SQUARE(4, 0), SQUARE(0, 0), 'Q'},
+  {CASTLING_BLACK_SHORT, false, SQUARE(4, 7), SQUARE(7, 7), 'k'},
+  {CASTLING_BLACK_LONG, false, SQUARE(4, 7), SQUARE(0, 7), 'q'},
+};
+
+/**
+ * @brief Converts a FEN piece letter to a piece type.
+ *
+ * @param letter Letter of either case.
+ * @return The piece type, or EMPTY if the letter names no piece.
+ */
+static enum PieceType letter_to_type(char letter) {
+  switch (letter | 0x20) {
+    case 'p': return PAWN;
+    case 'r': return ROOK;
+    case 'n': return KNIGHT;
+    case 'b': return BISHOP;
+    case 'q': return QUEEN;
+    case 'k': return KING;
+    default: return EMPTY;
+  }
+}
+
+/**
+ * @brief Skips the spaces before a field.
+ *
+ * @param text Current position in the record.
+ * @return Start of the next field.
+ */
+static const char *skip_spaces(const char *text) {
+  while (*text == ' ') {
+    text++;
+  }
+  return text;
+}
+
+/**
+ * @brief Reads a non-negative decimal number.
+ *
+ * @param text Pointer to the current position in the record, moved past the number.
+ * @param value Filled with the number.
+ * @return 0 upon success, 1 if there is no digit or the number is too large.
+ */
+static int read_number(const char **text, int *value) {
+  const char *p = *text;
+  int n = 0;
+
+  if (*p < '0' || *p > '9') {
+    return 1;
+  }
+  while (*p >= '0' && *p <= '9') {
+    if (n > 100000000) {
+      return 1;
+    }
+    n = n * 10 + (*p++ - '0');
+  }
+  *text = p;
+  *value = n;
+  return 0;
+}
+
+/**
+ * @brief Writes a non-negative decimal number.
+ *
+ * @param str Where the digits are written.
+ * @param value The number.
+ * @return Number of characters written.
+ */
+static int write_number(char *str, int value) {
+  char digits[12];
+  int count = 0;
+
+  do {
+    digits[count++] = '0' + value % 10;
+    value /= 10;
+  } while (value > 0);
+
+  for (int i = 0; i < count; i++) {
+    str[i] = digits[count - 1 - i];
+  }
+  return count;
+}
+
+/**
+ * @brief Reads the piece placement field into an empty position.
+ *
+ * @param text Pointer to the current position in the record, moved past the field.
+ * @param bb Pointer to the position the pieces are put on.
+ * @return 0 upon success, 1 if the field does not describe exactly eight ranks of eight squares.
+ */
+static int read_placement(const char **text, struct Bitboard *bb) {
+  const char *p = *text;
+  int x = 0;
+  int y = 7;
+
+  for (; *p && *p != ' '; p++) {
+    if (*p == '/') {
+      if (x != 8 || y == 0) {
+        return 1;
+      }
+      x = 0;
+      y--;
+    }
+    else if (*p >= '1' && *p <= '8') {
+      x += *p - '0';
+      if (x > 8) {
+        return 1;
+      }
+    }
+    else {
+      enum PieceType type = letter_to_type(*p);
+      if (type == EMPTY || x == 8) {
+        return 1;
+      }
+      bitboard_put_piece(bb, type, *p < 'a', SQUARE(x, y));
+      x++;
+    }
+  }
+
+  *text = p;
+  return x == 8 && y == 0 ? 0 : 1;
+}
+
+/**
+ * @brief Checks that a position can occur in a game.
+ *
+ * @param bb Pointer to the position, with its attack maps up to date.
+ * @return 0 if the position is possible, 1 otherwise.
+ */
+static int check_position(const struct Bitboard *bb) {
+  for (int color = WHITE; color <= BLACK; color++) {
+    if (bitboard_count(bb->pieces[color][KING]) != 1 || bitboard_count(bb->colors[color]) > 16) {
+      return 1;
+    }
+    if (bb->pieces[color][PAWN] & (RANK_1 | RANK_8)) {
+      return 1;
+    }
+  }
+
+  int enemyKing = bitboard_lsb(bb->pieces[COLOR(!bb->isWhiteTurn)][KING]);
+  return is_square_attacked(bb, enemyKing, bb->isWhiteTurn) ? 1 : 0;
+}
+
+/**
+ * @brief Copies a checked position into the board of a game.
+ *
+ * This function lays the pieces out as init_board does, white in slots 0 to 15 and black in slots 16 to 31, and marks the
+ * pawns off their initial rank and the kings and rooks without castling rights as moved.
+ *
+ * @param board Pointer to the board to be filled.
+ * @param bb Pointer to the position.
+ * @return Number of pieces on the board.
+ */
+static int fill_board(struct Board *board, const struct Bitboard *bb) {
+  int next[2] = {0, 16};
+  uint64_t occupied = bb->occupied;
+
+  board->movesIndex = 0;
+  board->bitboard = *bb;
+  eval_compute(bb, &board->eval);
+  memset(board->squareSlot, NO_PIECE, sizeof(board->squareSlot));
+
+  while (occupied) {
+    int sq = bitboard_pop_lsb(&occupied);
+    enum PieceType type;
+    bool isWhite;
+    bitboard_piece_at(bb, sq, &type, &isWhite);
+
+    bool hasMoved = false;
+    if (type == PAWN) {
+      hasMoved = SQUARE_Y(sq) != (isWhite ? 1 : 6);
+    }
+    else if (type == KING || type == ROOK) {
+      hasMoved = true;
+      for (int i = 0; i < 4; i++) {
+        const struct CastlingSquares *c = &castling_squares[i];
+        if ((bb->castling & c->right) && c->isWhite == isWhite && (sq == c->king || sq == c->rook)) {
+          hasMoved = false;
+        }
+      }
+    }
+
+    int slot = next[COLOR(isWhite)]++;
+    struct Piece piece = {type, {SQUARE_X(sq), SQUARE_Y(sq)}, true, isWhite, true, hasMoved, false, slot + 1};
+    board->pieces[slot] = piece;
+    board->squareSlot[sq] = slot;
+  }
+
+  for (int color = WHITE; color <= BLACK; color++) {
+    for (int slot = next[color]; slot < 16 * (color + 1); slot++) {
+      struct Piece none = {EMPTY, {-1, -1}, false, color == WHITE, false, true, false, slot + 1};
+      board->pieces[slot] = none;
+    }
+  }
+  return bitboard_count(bb->occupied);
+}
+
+/**
+ * @brief Sets a game to the position described by a FEN record, with an empty move history.
+ *
+ * This function reads the six fields in order into a local bitboard, drops the castling rights and en passant square the
+ * position cannot use, rebuilds the attack maps, checks the position and only then fills the game: the board, the turn,
+ * the clocks, the hash and the legal-destination cache.
+ *
+ * @param game Pointer to the game to be set up; unchanged if the record is rejected.
+ * @param fen Null-terminated FEN record.
+ * @return 0 upon success, 1 if the record is malformed or the position is impossible.
+ */
+int game_from_fen(struct Game *game, const char *fen) {
+  struct Bitboard bb;
+  const char *p = skip_spaces(fen);
+  int halfmoveClock = 0;
+  int fullmoveNumber = 1;
+
+  if (init_bitboard_tables() != 0) {
+    return 1;
+  }
+  bitboard_clear(&bb);
+
+  if (read_placement(&p, &bb) != 0) {
+    return 1;
+  }
+
+  p = skip_spaces(p);
+  if (*p != 'w' && *p != 'b') {
+    return 1;
+  }
+  bb.isWhiteTurn = *p++ == 'w';
+
+  p = skip_spaces(p);
+  if (*p == '-') {
+    p++;
+  }
+  else {
+    for (; *p && *p != ' '; p++) {
+      int i = 0;
+      while (i < 4 && castling_squares[i].letter != *p) {
+        i++;
+      }
+      if (i == 4) {
+        return 1;
+      }
+      const struct CastlingSquares *c = &castling_squares[i];
+      if ((bb.pieces[COLOR(c->isWhite)][KING] & SQUARE_BIT(c->king)) && (bb.pieces[COLOR(c->isWhite)][ROOK] & SQUARE_BIT(c->rook))) {
+        bb.castling |= c->right;
+      }
+    }
+  }
+
+  p = skip_spaces(p);
+  if (*p == '-') {
+    p++;
+  }
+  else {
+    if (p[0] < 'a' || p[0] > 'h' || p[1] != (bb.isWhiteTurn ? '6' : '3')) {
+      return 1;
+    }
+    int ep = SQUARE(p[0] - 'a', p[1] - '1');
+    int pushed = bb.isWhiteTurn ? ep - 8 : ep + 8;
+    if ((bb.pieces[COLOR(!bb.isWhiteTurn)][PAWN] & SQUARE_BIT(pushed)) && !(bb.occupied & SQUARE_BIT(ep)) &&
+        (pawn_attacks(!bb.isWhiteTurn, ep) & bb.pieces[COLOR(bb.isWhiteTurn)][PAWN])) {
+      bb.epSquare = ep;
+    }
+    p += 2;
+  }
+
+  p = skip_spaces(p);
+  if (*p && read_number(&p, &halfmoveClock) != 0) {
+    return 1;
+  }
+  p = skip_spaces(p);
+  if (*p && read_number(&p, &fullmoveNumber) != 0) {
+    return 1;
+  }
+  if (*skip_spaces(p) != '\0') {
+    return 1;
+  }
+
+  update_attack_maps(&bb);
+  if (check_position(&bb) != 0) {
+    return 1;
+  }
+
+  game->piece_count = fill_board(&game->board, &bb);
+  game->state = START;
+  game->isWhiteTurn = bb.isWhiteTurn;
+  game->halfmoveClock = halfmoveClock;
+  game->fullmoveNumber = fullmoveNumber > 0 ? fullmoveNumber : 1;
+  game->undoIndex = 0;
+  game->hash = zobrist_hash(&bb);
+  game->pawnHash = zobrist_pawn_hash(&bb);
+  game->hashHistory[0] = game->hash;
+  update_legal_targets(game);
+  return 0;
+}
+
+/**
+ * @brief Writes the FEN record of the current position of a game.
+ *
+ * This function reads the pieces through the square index, counting runs of empty squares, and writes the en passant
+ * square only when a pawn can capture into it, as the board keeps it.
+ *
+ * @param game Pointer to the game.
+ * @param fen Buffer of at least FEN_MAX_LENGTH characters the null-terminated record is written into.
+ * @return Length of the record.
+ */
+int game_to_fen(const struct Game *game, char *fen) {
+  const struct Board *board = &game->board;
+  const struct Bitboard *bb = &board->bitboard;
+  char *p = fen;
+
+  for (int y = 7; y >= 0; y--) {
+    int empty = 0;
+    for (int x = 0; x < 8; x++) {
+      int slot = board->squareSlot[SQUARE(x, y)];
+      if (slot == NO_PIECE) {
+        empty++;
+        continue;
+      }
+      if (empty) {
+        *p++ = '0' + empty;
+        empty = 0;
+      }
+      const struct Piece *piece = &board->pieces[slot];
+      *p++ = piece->isWhite ? piece_letters[piece->type] - 0x20 : piece_letters[piece->type];
+    }
+    if (empty) {
+      *p++ = '0' + empty;
+    }
+    if (y > 0) {
+      *p++ = '/';
+    }
+  }
+
+  *p++ = ' ';
+  *p++ = bb->isWhiteTurn ? 'w' : 'b';
+
+  *p++ = ' ';
+  if (bb->castling == 0) {
+    *p++ = '-';
+  }
+  for (int i = 0; i < 4; i++) {
+    if (bb->castling & castling_squares[i].right) {
+      *p++ = castling_squares[i].letter;
+    }
+  }
+
+  *p++ = ' ';
+  if (bb->epSquare == NO_SQUARE) {
+    *p++ = '-';
+  }
+  else {
+    *p++ = 'a' + SQUARE_X(bb->epSquare);
+    *p++ = '1' + SQUARE_Y(bb->epSquare);
+  }
+
+  *p++ = ' ';
+  p += write_number(p, game->halfmoveClock);
+  *p++ = ' ';
+  p += write_number(p, game->fullmoveNumber);
+  *p = '\0';
+  return p - fen;
+}
@@ -0,0 +1,41 @@
+/**
+ * @file fen.h
+ * @brief Header file containing the FEN (Forsyth-Edwards Notation) reader and writer.
+ *
+ * A FEN record describes a position in one line: the pieces rank by rank from the eighth, the
+ * side to move, the castling rights, the en passant square and the two move clocks. Neither
+ * direction allocates memory, so positions can be loaded and saved in bulk.
+ */
+
+#pragma once
+
+#include "../game.h"
+
+/** @brief FEN of the starting position. */
+#define FEN_START "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"
+
+/** @brief Size of a buffer large enough for any FEN written by game_to_fen, null terminator included. */
+#define FEN_MAX_LENGTH 128
+
+/**
+ * @brief Sets a game to the position described by a FEN record, with an empty move history.
+ *
+ * The move clocks may be left out, in which case they default to 0 and 1. Castling rights whose king or rook
+ * is not on its initial square are dropped, and so is an en passant square no pawn can capture into. The players
+ * and their clocks are left untouched.
+ *
+ * @param game Pointer to the game to be set up; unchanged if the record is rejected.
+ * @param fen Null-terminated FEN record.
+ * @return 0 upon success, 1 if the record is malformed or the position is impossible (wrong number of kings,
+ * pawns on the first or last rank, more than 16 pieces of a color, or the side not to move in check).
+ */
+int game_from_fen(struct Game *game, const char *fen);
+
+/**
+ * @brief Writes the FEN record of the current position of a game.
+ *
+ * @param game Pointer to the game.
+ * @param fen Buffer of at least FEN_MAX_LENGTH characters the null-terminated record is written into.
+ * @return Length of the record.
+ */
+int game_to_fen(const struct Game *game, char *fen);
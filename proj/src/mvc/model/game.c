@@ -7,10 +7,15 @@
  */
 
 #include "game.h"
+#include "engine/evaluate.h"
 #include "../view/view.h"
 
+#include <string.h>
+
 extern enum FlowState current_state;
 
+bool board_invariants_enabled = false;
+
 /**
  * @brief Creates a new game instance.
  *
@@ -122,76 +127,408 @@ void init_player(struct Player *player, bool isWhite, int minutes, int seconds)
  */
 void changeTurn(struct Game *game) {
   game->isWhiteTurn = !game->isWhiteTurn;
+  game->board.bitboard.isWhiteTurn = game->isWhiteTurn;
 }
 
 /**
  * @brief Moves a piece on the board if the move is legal.
  *
- * This function attempts to move a piece on the board from the initial position to the final position, provided that the move is legal according to the rules of chess. If the move is valid, the function updates the position of the piece on the board.
+ * This function looks the move up in the legal-destination cache and, if it is legal, finds the matching encoded move (promotions always make a queen) and plays it with play_move.
  *
  * @param game A pointer to the Game structure representing the current game state.
- * @param PieceType The type of the piece being moved.
- * @param piece A pointer to the Piece structure representing the piece being moved.
  * @param init_pos A pointer to the initial Position structure representing the piece's current position.
  * @param final_pos A pointer to the final Position structure representing the desired destination position.
+ * @return true if the piece was moved, false otherwise.
+ */
+bool move_piece(struct Game *game, struct Position *init_pos, struct Position *final_pos) {
+  if (!is_legal_move(game, init_pos, final_pos)) {
+    return false;
+  }
+
+  int from = SQUARE(init_pos->x, init_pos->y);
+  int to = SQUARE(final_pos->x, final_pos->y);
+  struct MoveBuffer moves;
+  generate_legal_moves(&game->board.bitboard, &moves);
+
+  for (int i = 0; i < moves.index; i++) {
+    uint16_t move = moves.moves[i];
+    if (MOVE_FROM(move) == from && MOVE_TO(move) == to &&
+        (!MOVE_IS_PROMOTION(move) || move_promotion(move) == QUEEN)) {
+      return play_move(game, move) == 0;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Finds the piece standing on a square.
+ *
+ * @param board A pointer to the Board structure representing the game board.
+ * @param sq Square index.
+ * @return The index of the piece in the board's pieces array, or NO_PIECE if the square is empty.
  */
-void move_piece(struct Game *game, enum PieceType PieceType, struct Piece *piece,
-                struct Position *init_pos, struct Position *final_pos) {
+static inline int find_piece_slot(struct Board *board, int sq) {
+  return board->squareSlot[sq];
+}
+
+/**
+ * @brief Marks a square as empty in the square index.
+ *
+ * @param board A pointer to the Board structure representing the game board.
+ * @param sq Square index.
+ */
+static inline void clear_square(struct Board *board, int sq) {
+  board->squareSlot[sq] = NO_PIECE;
+}
+
+/**
+ * @brief Places a piece of the pieces array on a square, updating both directions of the index.
+ *
+ * @param board A pointer to the Board structure representing the game board.
+ * @param slot Index of the piece in the board's pieces array.
+ * @param sq Square index.
+ */
+static inline void place_piece(struct Board *board, int slot, int sq) {
+  board->pieces[slot].position.x = SQUARE_X(sq);
+  board->pieces[slot].position.y = SQUARE_Y(sq);
+  board->squareSlot[sq] = slot;
+}
+
+/**
+ * @brief Returns the origin and destination squares of the rook in a castling move.
+ *
+ * @param move Encoded castling move.
+ * @param rookFrom Filled with the initial square of the rook.
+ * @param rookTo Filled with the square the rook lands on.
+ */
+static void castling_rook_squares(uint16_t move, int *rookFrom, int *rookTo) {
+  int to = MOVE_TO(move);
+  *rookFrom = MOVE_FLAGS(move) == MOVE_KING_CASTLE ? to + 1 : to - 2;
+  *rookTo = MOVE_FLAGS(move) == MOVE_KING_CASTLE ? to - 1 : to + 1;
+}
+
+/**
+ * @brief Plays an encoded move on the board and pushes its undo record.
+ *
+ * This function updates only what the move touches: the moving piece, the captured piece (en passant included), the rook when castling and the pawn type when promoting, in the pieces array, the square index and the bitboards. The Zobrist hash and the evaluation terms are updated with the keys and the piece-square values of the same changes, the hash also with the castling, en passant and side-to-move keys, and the pawn hash with the keys of the pawns that move or disappear. The undo record keeps the captured piece and the castling, en passant and halfmove state the move overwrites, so that unmake_move can restore the position without copying the board.
+ *
+ * @param game A pointer to the Game structure representing the current game state.
+ * @param move Encoded legal move.
+ * @return 0 upon success, 1 if the undo stack is full or no piece stands on the origin square.
+ */
+int make_move(struct Game *game, uint16_t move) {
   struct Board *board = &game->board;
-  if (is_movement_legal(board, PieceType, piece, init_pos, final_pos) && is_inside_board(final_pos) && piece->isWhite == game->isWhiteTurn) {
-    for (int i = 0; i < 32; i++) {
-      if (game->board.pieces[i].position.x == init_pos->x &&
-          game->board.pieces[i].position.y == init_pos->y) {
-        game->board.pieces[i].position.x = final_pos->x;
-        game->board.pieces[i].position.y = final_pos->y;
-        break;
-      }
+  struct Bitboard *bb = &board->bitboard;
+  int from = MOVE_FROM(move);
+  int to = MOVE_TO(move);
+  int slot = find_piece_slot(board, from);
+
+  if (slot < 0 || game->undoIndex >= MAX_PLIES) {
+    return 1;
+  }
+
+  struct Piece *piece = &board->pieces[slot];
+  struct Undo *undo = &game->undoStack[game->undoIndex++];
+  undo->move = move;
+  undo->captured = EMPTY;
+  undo->capturedSlot = -1;
+  undo->castling = bb->castling;
+  undo->epSquare = bb->epSquare;
+  undo->hasMoved = piece->hasMoved;
+  undo->halfmoveClock = game->halfmoveClock;
+  undo->info = bb->info;
+  undo->hash = game->hash;
+  undo->pawnHash = game->pawnHash;
+  undo->eval = board->eval;
+
+  uint64_t hash = game->hash ^ zobrist_castling[bb->castling] ^ zobrist_side;
+  if (bb->epSquare != NO_SQUARE) {
+    hash ^= zobrist_ep[SQUARE_X(bb->epSquare)];
+  }
+
+  if (MOVE_IS_CAPTURE(move)) {
+    int capturedSquare = MOVE_FLAGS(move) == MOVE_EP_CAPTURE ? to + (piece->isWhite ? -8 : 8) : to;
+    int capturedSlot = find_piece_slot(board, capturedSquare);
+    struct Piece *captured = &board->pieces[capturedSlot];
+
+    undo->captured = captured->type;
+    undo->capturedSlot = capturedSlot;
+    captured->type = EMPTY;
+    captured->isAlive = false;
+    captured->position.x = -1;
+    captured->position.y = -1;
+    hash ^= zobrist_pieces[COLOR(captured->isWhite)][undo->captured][capturedSquare];
+    if (undo->captured == PAWN) {
+      game->pawnHash ^= zobrist_pieces[COLOR(captured->isWhite)][PAWN][capturedSquare];
     }
+    eval_remove_piece(&board->eval, undo->captured, captured->isWhite, capturedSquare);
+    clear_square(board, capturedSquare);
+    bitboard_remove_piece(bb, capturedSquare);
+    game->piece_count--;
+  }
+
+  game->halfmoveClock = (undo->captured != EMPTY || piece->type == PAWN) ? 0 : game->halfmoveClock + 1;
+  if (!piece->isWhite) {
+    game->fullmoveNumber++;
+  }
+
+  hash ^= zobrist_pieces[COLOR(piece->isWhite)][piece->type][from];
+  if (piece->type == PAWN) {
+    game->pawnHash ^= zobrist_pieces[COLOR(piece->isWhite)][PAWN][from];
+  }
+  eval_remove_piece(&board->eval, piece->type, piece->isWhite, from);
+  bitboard_move_piece(bb, from, to);
+  clear_square(board, from);
+  piece->hasMoved = true;
+  if (MOVE_IS_PROMOTION(move)) {
+    piece->type = move_promotion(move);
+    bitboard_remove_piece(bb, to);
+    bitboard_put_piece(bb, piece->type, piece->isWhite, to);
+  }
+  hash ^= zobrist_pieces[COLOR(piece->isWhite)][piece->type][to];
+  if (piece->type == PAWN) {
+    game->pawnHash ^= zobrist_pieces[COLOR(piece->isWhite)][PAWN][to];
+  }
+  eval_put_piece(&board->eval, piece->type, piece->isWhite, to);
+  place_piece(board, slot, to);
+
+  if (MOVE_FLAGS(move) == MOVE_KING_CASTLE || MOVE_FLAGS(move) == MOVE_QUEEN_CASTLE) {
+    int rookFrom, rookTo;
+    castling_rook_squares(move, &rookFrom, &rookTo);
+    int rookSlot = find_piece_slot(board, rookFrom);
+    bitboard_move_piece(bb, rookFrom, rookTo);
+    clear_square(board, rookFrom);
+    board->pieces[rookSlot].hasMoved = true;
+    place_piece(board, rookSlot, rookTo);
+    hash ^= zobrist_pieces[COLOR(piece->isWhite)][ROOK][rookFrom] ^ zobrist_pieces[COLOR(piece->isWhite)][ROOK][rookTo];
+    eval_remove_piece(&board->eval, ROOK, piece->isWhite, rookFrom);
+    eval_put_piece(&board->eval, ROOK, piece->isWhite, rookTo);
+  }
+
+  hash ^= zobrist_castling[bb->castling];
+  if (bb->epSquare != NO_SQUARE) {
+    hash ^= zobrist_ep[SQUARE_X(bb->epSquare)];
+  }
+  game->hash = hash;
+  game->hashHistory[game->undoIndex % HASH_HISTORY] = hash;
+
+  changeTurn(game);
+  update_attack_maps(bb);
+
+  if (board_invariants_enabled && (verify_board(board) != 0 || game->hash != zobrist_hash(bb) || game->pawnHash != zobrist_pawn_hash(bb))) {
+    printf("board invariant broken after move %d-%d\n", from, to);
   }
+  return 0;
 }
 
 /**
- * @brief Checks if the current player's king is in check.
+ * @brief Passes the turn without moving (a null move), for the search to test whether the position is good even so.
  *
- * This function determines if the current player's king is in check, meaning it is under attack by an opponent's piece and is threatened with capture on the next move.
+ * This function pushes an undo record like make_move does, hands the turn over and drops the en passant square. The halfmove clock restarts, so repetitions are never matched across the null move.
+ *
+ * @param game A pointer to the Game structure representing the current game state; the side to move must not be in check.
+ * @return 0 upon success, 1 if the undo stack is full.
+ */
+int make_null_move(struct Game *game) {
+  struct Bitboard *bb = &game->board.bitboard;
+
+  if (game->undoIndex >= MAX_PLIES) {
+    return 1;
+  }
+
+  struct Undo *undo = &game->undoStack[game->undoIndex++];
+  undo->move = NO_MOVE;
+  undo->captured = EMPTY;
+  undo->capturedSlot = -1;
+  undo->castling = bb->castling;
+  undo->epSquare = bb->epSquare;
+  undo->halfmoveClock = game->halfmoveClock;
+  undo->info = bb->info;
+  undo->hash = game->hash;
+
+  uint64_t hash = game->hash ^ zobrist_side;
+  if (bb->epSquare != NO_SQUARE) {
+    hash ^= zobrist_ep[SQUARE_X(bb->epSquare)];
+    bb->epSquare = NO_SQUARE;
+  }
+  game->hash = hash;
+  game->hashHistory[game->undoIndex % HASH_HISTORY] = hash;
+  game->halfmoveClock = 0;
+
+  changeTurn(game);
+  update_attack_maps(bb);
+  return 0;
+}
+
+/**
+ * @brief Takes back the null move made with make_null_move.
  *
  * @param game A pointer to the Game structure representing the current game state.
- * @return true if the current player's king is in check, false otherwise.
+ * @return 0 upon success, 1 if there is no move to take back.
  */
-bool is_check(struct Game *game) {
+int unmake_null_move(struct Game *game) {
+  struct Bitboard *bb = &game->board.bitboard;
+
+  if (game->undoIndex == 0) {
+    return 1;
+  }
+
+  struct Undo *undo = &game->undoStack[--game->undoIndex];
+  changeTurn(game);
+  bb->epSquare = undo->epSquare;
+  game->halfmoveClock = undo->halfmoveClock;
+  bb->info = undo->info;
+  game->hash = undo->hash;
+  return 0;
+}
+
+/**
+ * @brief Takes back the last move made with make_move.
+ *
+ * This function pops the last undo record and replays the move backwards: the rook goes back when castling, a promoted piece turns back into a pawn, the moving piece returns to its origin and the captured piece reappears on its square. The castling rights, en passant square, halfmove clock, attack state, hashes and evaluation terms are restored from the record.
+ *
+ * @param game A pointer to the Game structure representing the current game state.
+ * @return 0 upon success, 1 if there is no move to take back.
+ */
+int unmake_move(struct Game *game) {
   struct Board *board = &game->board;
-  struct Position king_pos;
-  bool isWhite = game->isWhiteTurn;
+  struct Bitboard *bb = &board->bitboard;
 
-  for (int i = 0; i < 32; i++) {
-    if (board->pieces[i].type == KING) {
-      if (board->pieces[i].isWhite != game->isWhiteTurn) {
-        king_pos.x = board->pieces[i].position.x;
-        king_pos.y = board->pieces[i].position.y;
+  if (game->undoIndex == 0) {
+    return 1;
+  }
 
-        break;
-      }
-    }
+  struct Undo *undo = &game->undoStack[--game->undoIndex];
+  uint16_t move = undo->move;
+  int from = MOVE_FROM(move);
+  int to = MOVE_TO(move);
+  int slot = find_piece_slot(board, to);
+  struct Piece *piece = &board->pieces[slot];
+
+  changeTurn(game);
+
+  if (MOVE_FLAGS(move) == MOVE_KING_CASTLE || MOVE_FLAGS(move) == MOVE_QUEEN_CASTLE) {
+    int rookFrom, rookTo;
+    castling_rook_squares(move, &rookFrom, &rookTo);
+    int rookSlot = find_piece_slot(board, rookTo);
+    bitboard_move_piece(bb, rookTo, rookFrom);
+    clear_square(board, rookTo);
+    board->pieces[rookSlot].hasMoved = false;
+    place_piece(board, rookSlot, rookFrom);
   }
 
-  for (int i = 0; i < 32; i++) {
-    if (board->pieces[i].isWhite == isWhite && board->pieces[i].type != EMPTY && board->pieces[i].type != KING) {
-      struct Movelist possible_moves = get_possible_moves(game, &board->pieces[i]);
-
-      for (int j = 0; j < possible_moves.index; j++) {
-        struct Move *move = possible_moves.moves[j];
-        struct Position *init_pos = move->init_pos;
-        struct Position *final_pos = move->final_pos;
-
-        if (is_movement_legal_without_removing(board, board->pieces[i].type, &board->pieces[i], init_pos, final_pos) && king_pos.x == final_pos->x && king_pos.y == final_pos->y) {
-          return true;
-        }
-      }
-      free(possible_moves.moves);
-      possible_moves.index = 0;
-    }
+  if (MOVE_IS_PROMOTION(move)) {
+    piece->type = PAWN;
+    bitboard_remove_piece(bb, to);
+    bitboard_put_piece(bb, PAWN, piece->isWhite, to);
   }
-  return false;
+
+  bitboard_move_piece(bb, to, from);
+  clear_square(board, to);
+  piece->hasMoved = undo->hasMoved;
+  place_piece(board, slot, from);
+
+  if (undo->captured != EMPTY) {
+    int capturedSquare = MOVE_FLAGS(move) == MOVE_EP_CAPTURE ? to + (piece->isWhite ? -8 : 8) : to;
+    struct Piece *captured = &board->pieces[undo->capturedSlot];
+
+    captured->type = undo->captured;
+    captured->isAlive = true;
+    place_piece(board, undo->capturedSlot, capturedSquare);
+    bitboard_put_piece(bb, captured->type, captured->isWhite, capturedSquare);
+    game->piece_count++;
+  }
+
+  bb->castling = undo->castling;
+  bb->epSquare = undo->epSquare;
+  game->halfmoveClock = undo->halfmoveClock;
+  if (!piece->isWhite) {
+    game->fullmoveNumber--;
+  }
+  bb->info = undo->info;
+  game->hash = undo->hash;
+  game->pawnHash = undo->pawnHash;
+  board->eval = undo->eval;
+
+  if (board_invariants_enabled && verify_board(board) != 0) {
+    printf("board invariant broken after taking back %d-%d\n", from, to);
+  }
+  return 0;
+}
+
+/**
+ * @brief Recomputes the legal-destination cache of the side to move.
+ *
+ * This function runs the legal move generator once and ORs each destination into the mask of its origin square, so that legality and hover queries during the turn are single bit tests.
+ *
+ * @param game A pointer to the Game structure representing the current game state.
+ */
+void update_legal_targets(struct Game *game) {
+  struct MoveBuffer moves;
+
+  memset(game->legalTargets, 0, sizeof(game->legalTargets));
+  generate_legal_moves(&game->board.bitboard, &moves);
+  for (int i = 0; i < moves.index; i++) {
+    game->legalTargets[MOVE_FROM(moves.moves[i])] |= SQUARE_BIT(MOVE_TO(moves.moves[i]));
+  }
+}
+
+/**
+ * @brief Checks if moving the piece on a square to another square is legal.
+ *
+ * This function only reads the legal-destination cache, so it never changes the board.
+ *
+ * @param game A pointer to the Game structure representing the current game state.
+ * @param init_pos A pointer to the Position structure of the piece to be moved.
+ * @param final_pos A pointer to the Position structure of the destination.
+ * @return true if the side to move has a legal move between the two squares, false otherwise.
+ */
+bool is_legal_move(struct Game *game, struct Position *init_pos, struct Position *final_pos) {
+  if (!is_inside_board(init_pos) || !is_inside_board(final_pos)) {
+    return false;
+  }
+  return (game->legalTargets[SQUARE(init_pos->x, init_pos->y)] & SQUARE_BIT(SQUARE(final_pos->x, final_pos->y))) != 0;
+}
+
+/**
+ * @brief Plays a move of the game and prepares the next turn.
+ *
+ * This function is the entry point for moves that are actually played (as opposed to tried by make_move): it makes the move, refreshes the per-turn state of the new side to move and classifies the new position once, so the game end never has to be polled for.
+ *
+ * @param game A pointer to the Game structure representing the current game state.
+ * @param move Encoded legal move.
+ * @return 0 upon success, 1 otherwise.
+ */
+int play_move(struct Game *game, uint16_t move) {
+  if (make_move(game, move) != 0) {
+    return 1;
+  }
+
+  update_legal_targets(game);
+  changeState(game, evaluate_game_state(game));
+  return 0;
+}
+
+/**
+ * @brief Checks if the current player's king is in check.
+ *
+ * This function determines if the current player's king is in check, meaning it is under attack by an opponent's piece and is threatened with capture on the next move. The checkers are kept up to date by every move, so this is a single test.
+ *
+ * @param game A pointer to the Game structure representing the current game state.
+ * @return true if the current player's king is in check, false otherwise.
+ */
+bool is_check(struct Game *game) {
+  return game->board.bitboard.info.checkers != 0;
+}
+
+/**
+ * @brief Checks if the current player is checkmated.
+ *
+ * @param game A pointer to the Game structure representing the current game state.
+ * @return true if the current player is in check and has no legal move, false otherwise.
+ */
+bool is_checkmate(struct Game *game) {
+  return is_check(game) && !has_legal_move(&game->board.bitboard);
 }
 
 /**
@@ -203,152 +540,98 @@ bool is_check(struct Game *game) {
  * @return true if the game is in a stalemate state, false otherwise.
  */
 bool is_stalemate(struct Game *game) {
+  return !is_check(game) && !has_legal_move(&game->board.bitboard);
+}
 
-  if (game->isWhiteTurn) {
-    for (int i = 0; i < 16; i++) {
-      struct Piece piece = game->White_player.pieces[i];
+/**
+ * @brief Counts how many times the current position occurred before.
+ *
+ * This function compares the current hash with the hash history, only looking at positions with the same side to move and stopping at the last capture or pawn move, since no earlier position can repeat. The cost is therefore bounded by the halfmove clock rather than by the length of the game.
+ *
+ * @param game A pointer to the Game structure representing the current game state.
+ * @return Number of earlier occurrences of the current position.
+ */
+int count_repetitions(struct Game *game) {
+  int reversible = game->halfmoveClock < game->undoIndex ? game->halfmoveClock : game->undoIndex;
+  int count = 0;
 
-      if (piece.canMove) {
-        return false;
-      }
-    }
+  if (reversible >= HASH_HISTORY) {
+    reversible = HASH_HISTORY - 1;
   }
-  else {
-    for (int i = 0; i < 16; i++) {
-      struct Piece piece = game->Black_player.pieces[i];
 
-      if (piece.canMove) {
-        return false;
-      }
+  for (int back = 4; back <= reversible; back += 2) {
+    if (game->hashHistory[(game->undoIndex - back) % HASH_HISTORY] == game->hash) {
+      count++;
     }
   }
+  return count;
+}
 
-  return true;
+/**
+ * @brief Checks if the current position occurred for the third time.
+ *
+ * @param game A pointer to the Game structure representing the current game state.
+ * @return true if the position is a threefold repetition, false otherwise.
+ */
+bool is_threefold_repetition(struct Game *game) {
+  return count_repetitions(game) >= 2;
+}
+
+/**
+ * @brief Checks if fifty moves per side were played without a capture or a pawn move.
+ *
+ * @param game A pointer to the Game structure representing the current game state.
+ * @return true if the halfmove clock reached 100, false otherwise.
+ */
+bool is_fifty_move_rule(struct Game *game) {
+  return game->halfmoveClock >= 100;
 }
 
 /**
  * @brief Checks if the game is in a draw state.
  *
- * This function checks if the current game state qualifies as a draw based on the remaining pieces on the board. It considers various conditions such as pawn, queen, rook, bishop, and knight counts to determine if the game is in a draw state.
+ * This function checks if neither player has enough material left to checkmate: a king alone against a king with at most one minor piece, or kings with bishops that all stand on squares of the same color. Any pawn, rook or queen is enough to go on.
  *
  * @param game A pointer to the Game structure representing the current game state.
  * @return true if the game is in a draw state, false otherwise.
  */
 bool is_draw(struct Game *game) {
+  const struct Bitboard *bb = &game->board.bitboard;
 
-  int whiteKnightCount = 0;
-  int blackKnightCount = 0;
-  int whiteQueenCount = 0;
-  int blackQueenCount = 0;
-  int whiteBishopCount = 0;
-  int blackBishopCount = 0;
-  int whiteRookCount = 0;
-  int blackRookCount = 0;
-  int whitePawnCount = 0;
-  int blackPawnCount = 0;
-
-  for (int i = 0; i < 32; i++) {
-
-    switch (game->board.pieces[i].type) {
-      case PAWN:
-        if (game->board.pieces[i].isWhite) {
-          whitePawnCount++;
-        }
-        else {
-          blackPawnCount++;
-        }
-        break;
-      case ROOK:
-        if (game->board.pieces[i].isWhite) {
-          whiteRookCount++;
-        }
-        else {
-          blackRookCount++;
-        }
-        break;
-      case BISHOP:
-        if (game->board.pieces[i].isWhite) {
-          whiteBishopCount++;
-        }
-        else {
-          blackBishopCount++;
-        }
-        break;
-      case QUEEN:
-        if (game->board.pieces[i].isWhite) {
-          whiteQueenCount++;
-        }
-        else {
-          blackQueenCount++;
-        }
-        break;
-      case KNIGHT:
-        if (game->board.pieces[i].isWhite) {
-          whiteKnightCount++;
-        }
-        else {
-          blackKnightCount++;
-        }
-        break;
-      default:
-        break;
+  for (int color = 0; color < 2; color++) {
+    if (bb->pieces[color][PAWN] | bb->pieces[color][ROOK] | bb->pieces[color][QUEEN]) {
+      return false;
     }
   }
 
-  if (whitePawnCount > 0 || blackPawnCount > 0 || blackQueenCount > 0 || whiteQueenCount > 0 || blackRookCount > 0 || whiteRookCount > 0) {
-    return false;
-  }
-
-  if ((whiteBishopCount == 2 || blackBishopCount == 2)) {
-    return false;
-  }
+  uint64_t knights = bb->pieces[0][KNIGHT] | bb->pieces[1][KNIGHT];
+  uint64_t bishops = bb->pieces[0][BISHOP] | bb->pieces[1][BISHOP];
+  int minors = bitboard_count(knights | bishops);
 
-  if ((whiteBishopCount == 1 && whiteKnightCount == 1) ||
-      (blackBishopCount == 1 && blackKnightCount == 1)) {
-    return false;
+  if (minors <= 1) {
+    return true;
   }
-
-  return true;
+  return knights == 0 && ((bishops & DARK_SQUARES) == 0 || (bishops & ~DARK_SQUARES) == 0);
 }
 
 /**
- * @brief Gets the possible legal moves for a given piece on the board.
+ * @brief Classifies the position reached by the last move.
  *
- * This function determines all possible legal moves for a given piece on the chessboard based on the current game state. It considers the rules of movement without actually removing any pieces from the board.
+ * This function decides everything in one pass over the position: the legal-move test stops at the first legal move, so an ordinary position costs a few bit operations, and the full search for a move only happens when the side to move is close to being mated.
  *
  * @param game A pointer to the Game structure representing the current game state.
- * @param piece A pointer to the Piece structure for which possible moves are to be determined.
- * @return A Movelist structure containing an array of Move structures representing the possible moves for the piece.
+ * @return CHECKMATE, STALEMATE, DRAW (insufficient material, repetition, fifty-move rule or GAME_MAX_PLIES reached), CHECK or ONGOING.
  */
-struct Movelist get_possible_moves(struct Game *game, struct Piece *piece) {
-  struct Movelist possible_moves;
-  possible_moves.index = 0;
-  struct Position pos;
+enum GameStates evaluate_game_state(struct Game *game) {
+  bool check = is_check(game);
 
-  for (int i = 0; i < 8; i++) {
-    for (int j = 0; j < 8; j++) {
-      pos.x = i;
-      pos.y = j;
-
-      if (is_movement_legal_without_removing(&game->board, piece->type, piece, &piece->position, &pos)) {
-        struct Move *move = malloc(sizeof(struct Move));
-        move->init_pos = malloc(sizeof(struct Position));
-        move->final_pos = malloc(sizeof(struct Position));
-        move->piece = malloc(sizeof(struct Piece));
-
-        move->piece = piece;
-        move->init_pos->x = piece->position.x;
-        move->init_pos->y = piece->position.y;
-        move->final_pos->x = i;
-        move->final_pos->y = j;
-
-        possible_moves.moves[possible_moves.index] = move;
-        possible_moves.index++;
-      }
-    }
+  if (!has_legal_move(&game->board.bitboard)) {
+    return check ? CHECKMATE : STALEMATE;
   }
-
-  return possible_moves;
+  if (is_draw(game) || is_threefold_repetition(game) || is_fifty_move_rule(game) || game->undoIndex >= GAME_MAX_PLIES) {
+    return DRAW;
+  }
+  return check ? CHECK : ONGOING;
 }
 
 /**
@@ -380,7 +663,7 @@ void destroy_board(struct Board *board) {
 /**
  * @brief Initializes the chessboard with pieces in their starting positions.
  *
- * This function initializes the chessboard with pieces in their starting positions. It sets up the board with empty squares and places white and black pieces according to standard chess starting positions.
+ * This function initializes the chessboard with pieces in their starting positions. It sets up the board with empty squares and places white and black pieces according to standard chess starting positions, then builds the bitboards from the pieces.
  *
  * @param board A pointer to the Board structure representing the game board.
  */
@@ -392,29 +675,19 @@ void init_board(struct Board *board) {
   }
 
   // Initialize squares
-  for (int i = 0; i < 8; i++) {
-    for (int j = 0; j < 8; j++) {
-      board->squares[i][j].type = EMPTY;
-      board->squares[i][j].position.x = i;
-      board->squares[i][j].position.y = j;
-      board->squares[i][j].isAlive = false;
-      board->squares[i][j].isWhite = false;
-      board->squares[i][j].canMove = false;
-      board->squares[i][j].hasMoved = false;
-    }
+  for (int i = 0; i < 64; i++) {
+    board->squareSlot[i] = NO_PIECE;
   }
 
   // Initialize white pawns
   for (int j = 0; j < 8; j++) {
     struct Piece whitePawn = {PAWN, {j, 1}, true, true, true, false, false, j + 1};
-    board->squares[j][1] = whitePawn;
     board->pieces[j] = whitePawn;
   }
 
   // Initialize black pawns
   for (int j = 0; j < 8; j++) {
     struct Piece blackPawn = {PAWN, {j, 6}, true, false, true, false, false, 9 + j};
-    board->squares[j][6] = blackPawn;
     board->pieces[16 + j] = blackPawn;
   }
 
@@ -430,7 +703,6 @@ void init_board(struct Board *board) {
     {ROOK, {7, 0}, true, true, true, false, false, 24}};
 
   for (int i = 0; i < 8; i++) {
-    board->squares[i][0] = whitePieces[i];
     board->pieces[8 + i] = whitePieces[i];
   }
 
@@ -446,117 +718,60 @@ void init_board(struct Board *board) {
     {ROOK, {7, 7}, true, false, true, false, false, 32}};
 
   for (int i = 0; i < 8; i++) {
-    board->squares[i][7] = blackPieces[i];
     board->pieces[24 + i] = blackPieces[i];
   }
-}
 
-/**
- * @brief Checks if there is any piece in front of a given position on the board.
- *
- * This function checks if there is any piece in front of a given initial position on the board in the direction of a given final position.
- *
- * @param board A pointer to the Board structure representing the game board.
- * @param initialPos A pointer to the Position structure representing the initial position.
- * @param finalPos A pointer to the Position structure representing the final position.
- * @return true if there is any piece in front, false otherwise.
- */
-bool is_piece_in_front(struct Board *board, struct Position *initialPos, struct Position *finalPos) {
-  if (initialPos->x == finalPos->x) {
-    if (initialPos->y < finalPos->y) {
-      for (int i = initialPos->y + 1; i < finalPos->y; i++) {
-        if (board->squares[initialPos->x][i].type != EMPTY) {
-          return true;
-        }
-      }
-    }
-    else {
-      for (int i = initialPos->y - 1; i > finalPos->y; i--) {
-        if (board->squares[initialPos->x][i].type != EMPTY) {
-          return true;
-        }
-      }
-    }
-  }
-  else if (initialPos->y == finalPos->y) {
-    if (initialPos->x < finalPos->x) {
-      for (int i = initialPos->x + 1; i < finalPos->x; i++) {
-        if (board->squares[i][initialPos->y].type != EMPTY) {
-          return true;
-        }
-      }
-    }
-    else {
-      for (int i = initialPos->x - 1; i > finalPos->x; i--) {
-        if (board->squares[i][initialPos->y].type != EMPTY) {
-          return true;
-        }
-      }
-    }
+  // Initialize the square index and the bitboards
+  init_bitboard_tables();
+  bitboard_clear(&board->bitboard);
+  for (int i = 0; i < 32; i++) {
+    board->squareSlot[SQUARE(board->pieces[i].position.x, board->pieces[i].position.y)] = i;
+    bitboard_put_piece(&board->bitboard, board->pieces[i].type, board->pieces[i].isWhite,
+                       SQUARE(board->pieces[i].position.x, board->pieces[i].position.y));
   }
-  return false;
+  board->bitboard.castling = CASTLING_ALL;
+  update_attack_maps(&board->bitboard);
+  eval_compute(&board->bitboard, &board->eval);
 }
 
 /**
- * @brief Checks if there is any piece in the diagonal path between two positions.
+ * @brief Sets a game to the starting position with an empty move history.
  *
- * This function checks if there is any piece in the diagonal path between the initial position and the final position on the board.
+ * This function initializes the board and every field that make_move keeps up to date (turn, halfmove clock, undo stack, hash history and legal-destination cache), leaving the players and their clocks untouched.
  *
- * @param board A pointer to the Board structure representing the game board.
- * @param initialPos A pointer to the Position structure representing the initial position.
- * @param finalPos A pointer to the Position structure representing the final position.
- * @return true if there is any piece in the diagonal path, false otherwise.
+ * @param game A pointer to the Game structure to be reset.
  */
-bool is_piece_in_diagonal(struct Board *board, struct Position *initialPos, struct Position *finalPos) {
-  if (initialPos->x < finalPos->x && initialPos->y < finalPos->y) {
-    for (int i = initialPos->x + 1, j = initialPos->y + 1; i < finalPos->x && j < finalPos->y; i++, j++) {
-      if (board->squares[i][j].type != EMPTY) {
-        return true;
-      }
-    }
-  }
-  else if (initialPos->x < finalPos->x && initialPos->y > finalPos->y) {
-    for (int i = initialPos->x + 1, j = initialPos->y - 1; i < finalPos->x && j > finalPos->y; i++, j--) {
-      if (board->squares[i][j].type != EMPTY) {
-        return true;
-      }
-    }
-  }
-  else if (initialPos->x > finalPos->x && initialPos->y < finalPos->y) {
-    for (int i = initialPos->x - 1, j = initialPos->y + 1; i > finalPos->x && j < finalPos->y; i--, j++) {
-      if (board->squares[i][j].type != EMPTY) {
-        return true;
-      }
-    }
-  }
-  else if (initialPos->x > finalPos->x && initialPos->y > finalPos->y) {
-    for (int i = initialPos->x - 1, j = initialPos->y - 1; i > finalPos->x && j > finalPos->y; i--, j--) {
-      if (board->squares[i][j].type != EMPTY) {
-        return true;
-      }
-    }
-  }
-
-  return false;
+void init_position(struct Game *game) {
+  init_board(&game->board);
+  game->state = START;
+  game->piece_count = 32;
+  game->isWhiteTurn = true;
+  game->halfmoveClock = 0;
+  game->fullmoveNumber = 1;
+  game->undoIndex = 0;
+  game->hash = zobrist_hash(&game->board.bitboard);
+  game->pawnHash = zobrist_pawn_hash(&game->board.bitboard);
+  game->hashHistory[0] = game->hash;
+  update_legal_targets(game);
 }
 
 /**
  * @brief Checks if a square on the board is occupied by a piece.
  *
- * This function checks if the square at the specified position on the board is occupied by a piece.
+ * This function checks if the square at the specified position on the board is occupied by a piece, by testing its bit in the occupancy bitboard.
  *
  * @param board A pointer to the Board structure representing the game board.
  * @param pos A pointer to the Position structure representing the position to be checked.
  * @return true if the square at the specified position is occupied by a piece, false otherwise.
  */
 bool is_square_occupied(struct Board *board, struct Position *pos) {
-  return board->squares[pos->x][pos->y].type != EMPTY;
+  return is_inside_board(pos) && (board->bitboard.occupied & SQUARE_BIT(SQUARE(pos->x, pos->y)));
 }
 
 /**
  * @brief Checks if a piece can take another piece at a given position.
  *
- * This function determines whether a piece can take another piece located at the specified position on the board. It checks if the target position is occupied by an opponent's piece, considering the color of the pieces involved.
+ * This function determines whether a piece can take another piece located at the specified position on the board. It checks if the target position is in the occupancy bitboard of the opponent's color.
  *
  * @param board A pointer to the Board structure representing the game board.
  * @param pos A pointer to the Position structure representing the position of the piece to be taken.
@@ -564,194 +779,7 @@ bool is_square_occupied(struct Board *board, struct Position *pos) {
  * @return true if the piece can take the opponent's piece at the specified position, false otherwise.
  */
 bool can_take(struct Board *board, struct Position *pos, struct Piece *piece) {
-  return board->squares[pos->x][pos->y].type != EMPTY &&
-         board->squares[pos->x][pos->y].isWhite != piece->isWhite;
-}
-
-/**
- * @brief Checks if a movement of a piece on the board is legal.
- *
- * This function determines whether a movement of a piece from an initial position to a final position on the board is legal according to the rules of chess. It considers the type of the piece, its initial and final positions, and the current state of the board. If the movement is legal, it may also update certain attributes of the piece and the board.
- *
- * @param board A pointer to the Board structure representing the game board.
- * @param PieceType The type of the piece being moved.
- * @param piece A pointer to the Piece structure representing the piece being moved.
- * @param init_pos A pointer to the initial Position structure.
- * @param final_pos A pointer to the final Position structure.
- * @return true if the movement is legal and false otherwise.
- */
-bool is_movement_legal(struct Board *board, enum PieceType PieceType, struct Piece *piece,
-                       struct Position *init_pos, struct Position *final_pos) {
-  switch (PieceType) {
-    case PAWN:
-      if (!piece->hasMoved) {
-        bool isPieceInFront = is_piece_in_front(board, init_pos, final_pos);
-        bool isSquareOccupied = is_square_occupied(board, final_pos);
-
-        if (((init_pos->y - final_pos->y) <= 2 &&
-             (init_pos->y - final_pos->y) > 0 && (piece->isWhite == false)) ||
-            ((init_pos->y - final_pos->y) >= -2 &&
-             (init_pos->y - final_pos->y) < 0 && (piece->isWhite == true))) {
-
-          if (!isSquareOccupied && !isPieceInFront && init_pos->x == final_pos->x) {
-            piece->hasMoved = true;
-            return true;
-          }
-
-          if (can_take(board, final_pos, piece) && (abs(init_pos->x - final_pos->x) == 1 && (init_pos->y - final_pos->y) == -1) && piece->isWhite == true) {
-            piece->hasMoved = true;
-            return true;
-          }
-
-          if (can_take(board, final_pos, piece) && (abs(init_pos->x - final_pos->x) == 1 && (init_pos->y - final_pos->y) == 1) && piece->isWhite == false) {
-            return true;
-          }
-
-          return false;
-        }
-      }
-      else {
-        bool isPieceInFront = is_piece_in_front(board, init_pos, final_pos);
-        bool isSquareOccupied = is_square_occupied(board, final_pos);
-
-        if (((init_pos->y - final_pos->y) == 1 && piece->isWhite == false) ||
-            ((init_pos->y - final_pos->y) == -1 && piece->isWhite == true)) {
-
-          if (!isSquareOccupied && !isPieceInFront && init_pos->x == final_pos->x) {
-            return true;
-          }
-
-          if (can_take(board, final_pos, piece) && (abs(init_pos->x - final_pos->x) == 1 && (init_pos->y - final_pos->y) == -1) && piece->isWhite == true) {
-            remove_piece_from_board(board, final_pos);
-            piece->hasMoved = true;
-            return true;
-          }
-
-          if (can_take(board, final_pos, piece) && (abs(init_pos->x - final_pos->x) == 1 && (init_pos->y - final_pos->y) == 1) && piece->isWhite == false) {
-            remove_piece_from_board(board, final_pos);
-            return true;
-          }
-
-          return false;
-        }
-      }
-      break;
-
-    case ROOK:
-      if (init_pos->x == final_pos->x || init_pos->y == final_pos->y) {
-        bool isPieceInFront = is_piece_in_front(board, init_pos, final_pos);
-        bool isSquareOccupied = is_square_occupied(board, final_pos);
-
-        if (!isSquareOccupied && !isPieceInFront) {
-          piece->hasMoved = true;
-          return true;
-        }
-
-        if (can_take(board, final_pos, piece) && (init_pos->x == final_pos->x || init_pos->y == final_pos->y) && !isPieceInFront) {
-          remove_piece_from_board(board, final_pos);
-          piece->hasMoved = true;
-          return true;
-        }
-      }
-      return false;
-      break;
-
-    case KNIGHT:
-      if (is_inside_board(final_pos)) {
-        int x_diff = init_pos->x - final_pos->x;
-        int y_diff = init_pos->y - final_pos->y;
-        bool isSquareOccupied = is_square_occupied(board, final_pos);
-        if ((abs(x_diff) == 2 && abs(y_diff) == 1) || (abs(x_diff) == 1 && abs(y_diff) == 2)) {
-          if (!isSquareOccupied) {
-            return true;
-          }
-
-          if (can_take(board, final_pos, piece)) {
-            remove_piece_from_board(board, final_pos);
-            return true;
-          }
-        }
-      }
-      break;
-
-      return false;
-      break;
-    case BISHOP:
-      if (is_inside_board(final_pos)) {
-        if (abs(init_pos->x - final_pos->x) == abs(init_pos->y - final_pos->y)) {
-          bool isPieceInDiagonal = is_piece_in_diagonal(board, init_pos, final_pos);
-          bool isSquareOccupied = is_square_occupied(board, final_pos);
-
-          if (isSquareOccupied && !isPieceInDiagonal && can_take(board, final_pos, piece)) {
-            remove_piece_from_board(board, final_pos);
-            return true;
-          }
-
-          if (!isSquareOccupied && !isPieceInDiagonal) {
-            return true;
-          }
-        }
-        return false;
-      }
-      break;
-    case QUEEN:
-      if (is_inside_board(final_pos)) {
-        if (init_pos->x == final_pos->x || init_pos->y == final_pos->y) {
-          bool isPieceInFront = is_piece_in_front(board, init_pos, final_pos);
-          bool isSquareOccupied = is_square_occupied(board, final_pos);
-
-          if (!isSquareOccupied && !isPieceInFront) {
-            piece->hasMoved = true;
-            return true;
-          }
-
-          if (can_take(board, final_pos, piece) && !isPieceInFront && (init_pos->x == final_pos->x || init_pos->y == final_pos->y)) {
-            remove_piece_from_board(board, final_pos);
-            piece->hasMoved = true;
-            return true;
-          }
-        }
-        else if (abs(init_pos->x - final_pos->x) == abs(init_pos->y - final_pos->y)) {
-          bool isPieceInDiagonal = is_piece_in_diagonal(board, init_pos, final_pos);
-          bool isSquareOccupied = is_square_occupied(board, final_pos);
-
-          if (isSquareOccupied && !isPieceInDiagonal && can_take(board, final_pos, piece)) {
-            remove_piece_from_board(board, final_pos);
-            return true;
-          }
-
-          if (!isSquareOccupied && !isPieceInDiagonal) {
-            return true;
-          }
-        }
-        return false;
-      }
-      break;
-    case KING:
-      if (is_inside_board(final_pos)) {
-        if (abs(init_pos->x - final_pos->x) <= 1 && abs(init_pos->y - final_pos->y) <= 1) {
-          bool isSquareOccupied = is_square_occupied(board, final_pos);
-
-          if (!isSquareOccupied) {
-            return true;
-          }
-
-          if (can_take(board, final_pos, piece) && board->squares[final_pos->x][final_pos->y].type != KING) {
-            remove_piece_from_board(board, final_pos);
-            return true;
-          }
-        }
-      }
-      return false;
-      break;
-    case CASTLE:
-      /* code */
-      break;
-    default:
-      break;
-  }
-
-  return false;
+  return is_inside_board(pos) && (board->bitboard.colors[COLOR(!piece->isWhite)] & SQUARE_BIT(SQUARE(pos->x, pos->y)));
 }
 
 /**
@@ -791,8 +819,8 @@ struct Piece *get_piece_from_click(int click_x, int click_y, int square_size, st
 
   if (is_inside_board(&pos)) {
 
-    if (board->squares[pos.x][pos.y].type != EMPTY) {
-      return &board->squares[pos.x][pos.y];
+    if (is_square_occupied(board, &pos)) {
+      return &board->pieces[board->squareSlot[SQUARE(pos.x, pos.y)]];
     }
   }
 
@@ -800,254 +828,65 @@ struct Piece *get_piece_from_click(int click_x, int click_y, int square_size, st
 }
 
 /**
- * @brief Changes the position of a piece on the board if the move is legal.
+ * @brief Checks that the pieces array, the square index and the bitboards describe the same position.
  *
- * This function checks if the movement of a piece from its initial position to the final position   
-is legal and within the board boundaries. If the move is valid, it updates the piece's position 
-on the board and in the piece's own data structure, and advances the piece.
+ * This function verifies both directions of the square index, that every piece is in the bitboard of its type and color, that no square is occupied without a piece, and that the attack state and the evaluation terms match a fresh computation. It prints the first inconsistency found.
  *
- * @param piece A pointer to the Piece structure to be moved.
- * @param init_pos A pointer to the Position structure representing the initial position of the piece.
- * @param final_pos A pointer to the Position structure representing the final position of the piece.
- * @param board A pointer to the Board structure containing the current game state.
- * @return true if the piece's position was successfully changed, false otherwise.
- */
-bool change_piece_position(struct Piece *piece,
-                           struct Position *init_pos, struct Position *final_pos, struct Board *board) {
-
-  if (is_movement_legal(board, piece->type, piece, init_pos, final_pos) && is_inside_board(final_pos)) {
-    for (int i = 0; i < 32; i++) {
-      if (board->pieces[i].position.x == init_pos->x && board->pieces[i].position.y == init_pos->y) {
-        advance_piece(piece, final_pos, board);
-        board->pieces[i].position.x = final_pos->x;
-        board->pieces[i].position.y = final_pos->y;
-        piece->position.x = final_pos->x;
-        piece->position.y = final_pos->y;
-        board->squares[final_pos->x][final_pos->y] = *piece;
-        board->squares[init_pos->x][init_pos->y].type = EMPTY;
-        return true;
-        break;
-      }
-    }
-  }
-  return false;
-}
-
-/**
- * @brief Removes a piece from the board at the specified position.
- * 
- * This function searches for a piece at the given position on the board and removes it. It sets the board square at the position to be empty and updates the piece's position and type to indicate it has been removed.
- * 
  * @param board A pointer to the Board structure representing the game board.
- * @param pos A pointer to the Position structure indicating the coordinates of the piece to be removed.
+ * @return 0 if the board is consistent, 1 otherwise.
  */
-void remove_piece_from_board(struct Board *board, struct Position *pos) {
+int verify_board(struct Board *board) {
+  struct Bitboard expected;
+  bitboard_clear(&expected);
+
   for (int i = 0; i < 32; i++) {
-    if (board->pieces[i].position.x == pos->x && board->pieces[i].position.y == pos->y) {
-
-      board->squares[pos->x][pos->y].type = EMPTY;
-      board->squares[pos->x][pos->y].isWhite = false;
-      board->squares[pos->x][pos->y].hasMoved = false;
-      board->pieces[i].type = EMPTY;
-      board->pieces[i].position.x = -1;
-      board->pieces[i].position.y = -1;
-      break;
+    struct Piece *piece = &board->pieces[i];
+    if (piece->type == EMPTY) {
+      continue;
+    }
+    if (!is_inside_board(&piece->position)) {
+      printf("piece %d is off the board\n", piece->id);
+      return 1;
     }
-  }
-}
-
 
-/**
- * @brief Checks if a piece's movement from an initial position to a final position is legal without removing the piece.
- * 
- * This function verifies the legality of a piece's movement on the board based on its type and the positions involved. It considers specific rules for each piece type, such as pawns, rooks, knights, bishops, queens, and kings.
- * 
- * @param board A pointer to the Board structure representing the game board.
- * @param PieceType An enumeration value representing the type of the piece (e.g., PAWN, ROOK, KNIGHT, BISHOP, QUEEN, KING).
- * @param piece A pointer to the Piece structure representing the piece to be moved.
- * @param init_pos A pointer to the Position structure indicating the initial position of the piece.
- * @param final_pos A pointer to the Position structure indicating the final position of the piece.
- * @return true if the movement is legal, false otherwise.
- */
-bool is_movement_legal_without_removing(struct Board *board, enum PieceType PieceType, struct Piece *piece,
-                                        struct Position *init_pos, struct Position *final_pos) {
-  switch (PieceType) {
-    case PAWN:
-      if (!piece->hasMoved) {
-        bool isPieceInFront = is_piece_in_front(board, init_pos, final_pos);
-        bool isSquareOccupied = is_square_occupied(board, final_pos);
-
-        if (((init_pos->y - final_pos->y) <= 2 &&
-             (init_pos->y - final_pos->y) > 0 && (piece->isWhite == false)) ||
-            ((init_pos->y - final_pos->y) >= -2 &&
-             (init_pos->y - final_pos->y) < 0 && (piece->isWhite == true))) {
-
-          if (!isSquareOccupied && !isPieceInFront && init_pos->x == final_pos->x) {
-            return true;
-          }
-
-          if (can_take(board, final_pos, piece) && (abs(init_pos->x - final_pos->x) == 1 && (init_pos->y - final_pos->y) == -1) && piece->isWhite == true) {
-            return true;
-          }
-
-          if (can_take(board, final_pos, piece) && (abs(init_pos->x - final_pos->x) == 1 && (init_pos->y - final_pos->y) == 1) && piece->isWhite == false) {
-            return true;
-          }
-
-          return false;
-        }
-      }
-      else {
-        bool isPieceInFront = is_piece_in_front(board, init_pos, final_pos);
-        bool isSquareOccupied = is_square_occupied(board, final_pos);
-
-        if (((init_pos->y - final_pos->y) == 1 && piece->isWhite == false) ||
-            ((init_pos->y - final_pos->y) == -1 && piece->isWhite == true)) {
-
-          if (!isSquareOccupied && !isPieceInFront && init_pos->x == final_pos->x) {
-            return true;
-          }
-
-          if (can_take(board, final_pos, piece) && (abs(init_pos->x - final_pos->x) == 1 && (init_pos->y - final_pos->y) == -1) && piece->isWhite == true) {
-            return true;
-          }
-
-          if (can_take(board, final_pos, piece) && (abs(init_pos->x - final_pos->x) == 1 && (init_pos->y - final_pos->y) == 1) && piece->isWhite == false) {
-            return true;
-          }
-
-          return false;
-        }
-      }
-      break;
-
-    case ROOK:
-      if (init_pos->x == final_pos->x || init_pos->y == final_pos->y) {
-        bool isPieceInFront = is_piece_in_front(board, init_pos, final_pos);
-        bool isSquareOccupied = is_square_occupied(board, final_pos);
-
-        if (!isSquareOccupied && !isPieceInFront) {
-          return true;
-        }
-
-        if (can_take(board, final_pos, piece) && (init_pos->x == final_pos->x || init_pos->y == final_pos->y)) {
-          return true;
-        }
-      }
-      return false;
-      break;
-
-    case KNIGHT:
-      if (is_inside_board(final_pos)) {
-        int x_diff = init_pos->x - final_pos->x;
-        int y_diff = init_pos->y - final_pos->y;
-        bool isSquareOccupied = is_square_occupied(board, final_pos);
-        if ((abs(x_diff) == 2 && abs(y_diff) == 1) || (abs(x_diff) == 1 && abs(y_diff) == 2)) {
-          if (!isSquareOccupied) {
-            return true;
-          }
-
-          if (can_take(board, final_pos, piece)) {
-            return true;
-          }
-        }
-      }
-      break;
+    int sq = SQUARE(piece->position.x, piece->position.y);
+    if (board->squareSlot[sq] != i) {
+      printf("square %d does not point to piece %d\n", sq, piece->id);
+      return 1;
+    }
+    if (expected.occupied & SQUARE_BIT(sq)) {
+      printf("two pieces on square %d\n", sq);
+      return 1;
+    }
+    bitboard_put_piece(&expected, piece->type, piece->isWhite, sq);
+  }
 
-      return false;
-      break;
-    case BISHOP:
-      if (is_inside_board(final_pos)) {
-        if (abs(init_pos->x - final_pos->x) == abs(init_pos->y - final_pos->y)) {
-          if (!is_square_occupied(board, final_pos) && !is_piece_in_diagonal(board, init_pos, final_pos)) {
-            bool isPieceInDiagonal = is_piece_in_diagonal(board, init_pos, final_pos);
-            bool isSquareOccupied = is_square_occupied(board, final_pos);
-
-            if (isSquareOccupied && can_take(board, final_pos, piece)) {
-              return true;
-            }
-
-            if (!isSquareOccupied && !isPieceInDiagonal) {
-              return true;
-            }
-          }
-        }
-        return false;
-      }
-      break;
-    case QUEEN:
-      if (is_inside_board(final_pos)) {
-        if (init_pos->x == final_pos->x || init_pos->y == final_pos->y) {
-          bool isPieceInFront = is_piece_in_front(board, init_pos, final_pos);
-          bool isSquareOccupied = is_square_occupied(board, final_pos);
-
-          if (!isSquareOccupied && !isPieceInFront) {
-            return true;
-          }
-
-          if (can_take(board, final_pos, piece) && (init_pos->x == final_pos->x || init_pos->y == final_pos->y)) {
-            return true;
-          }
-        }
-        else if (abs(init_pos->x - final_pos->x) == abs(init_pos->y - final_pos->y)) {
-          bool isPieceInDiagonal = is_piece_in_diagonal(board, init_pos, final_pos);
-          bool isSquareOccupied = is_square_occupied(board, final_pos);
-
-          if (isSquareOccupied && can_take(board, final_pos, piece)) {
-            return true;
-          }
-
-          if (!isSquareOccupied && !isPieceInDiagonal) {
-            return true;
-          }
-        }
-        return false;
-      }
-      break;
-    case KING:
-      if (is_inside_board(final_pos)) {
-        if (abs(init_pos->x - final_pos->x) <= 1 && abs(init_pos->y - final_pos->y) <= 1) {
-          bool isSquareOccupied = is_square_occupied(board, final_pos);
-
-          if (!isSquareOccupied) {
-            return true;
-          }
-
-          if (can_take(board, final_pos, piece)) {
-            return true;
-          }
-        }
-      }
-      return false;
-      break;
-    case CASTLE:
-      /* code */
-      break;
-    default:
-      break;
+  for (int sq = 0; sq < 64; sq++) {
+    if ((board->squareSlot[sq] != NO_PIECE) != ((expected.occupied & SQUARE_BIT(sq)) != 0)) {
+      printf("square %d is indexed but holds no piece\n", sq);
+      return 1;
+    }
   }
 
-  return false;
-}
+  if (memcmp(expected.pieces, board->bitboard.pieces, sizeof(expected.pieces)) != 0 ||
+      memcmp(expected.colors, board->bitboard.colors, sizeof(expected.colors)) != 0 ||
+      expected.occupied != board->bitboard.occupied) {
+    printf("bitboards disagree with the pieces array\n");
+    return 1;
+  }
 
-/**
- * @brief Promotes a pawn to a queen on the board.
- *
- * This function promotes a specified pawn to a queen. It updates the type of the piece in the pieces array and on the board's squares array. The function returns the index of the piece in the pieces array or -1 if not found.
- *
- * @param board A pointer to the Board structure representing the game board.
- * @param pawn A pointer to the Piece structure representing the pawn to be promoted.
- * @return The index of the promoted piece in the board's pieces array, or -1 if the pawn is not found.
- */
-int promote_pawn_to_queen(struct Board *board, struct Piece *pawn) {
+  expected = board->bitboard;
+  update_attack_maps(&expected);
+  if (memcmp(&expected.info, &board->bitboard.info, sizeof(expected.info)) != 0) {
+    printf("attack maps are out of date\n");
+    return 1;
+  }
 
-  for (int i = 0; i < 32; i++) {
-    if (board->pieces[i].position.x == pawn->position.x && board->pieces[i].position.y == pawn->position.y) {
-      board->pieces[i].type = QUEEN;
-      board->squares[pawn->position.x][pawn->position.y].type = QUEEN;
-      pawn->type = QUEEN;
-      return i;
-    }
+  struct EvalState eval;
+  eval_compute(&board->bitboard, &eval);
+  if (eval.mg != board->eval.mg || eval.eg != board->eval.eg || eval.phase != board->eval.phase) {
+    printf("evaluation terms are out of date\n");
+    return 1;
   }
-  return -1;
+  return 0;
 }
@@ -11,6 +11,9 @@
 #include <stdio.h>
 
 #include "enum.h"
+#include "bitboard/bitboard.h"
+#include "bitboard/zobrist.h"
+#include "movegen/movegen.h"
 
 #pragma once
 
@@ -66,30 +69,30 @@ struct Piece
   int id; /**< id of the piece */
 };
 
-/**
- * @brief Structure representing a move made by a player.
- */
-struct Move {
-  struct Piece *piece; /**< piece that was moved */
-  struct Position *init_pos; /**< initial position of the piece */
-  struct Position *final_pos; /**< final position of the piece */
-};
+/** @brief Value of the square index for an empty square. */
+#define NO_PIECE -1
 
 /**
- * @brief Structure representing a list of moves.
+ * @brief Structure representing the evaluation terms kept up to date as pieces move.
+ *
+ * Scores are material plus piece-square values, white minus black, in centipawns.
  */
-struct Movelist {
-  struct Move *moves[1024]; /**< array of moves */
-  int index; /**< index of the last move */
+struct EvalState {
+  int mg;    /**< score with the midgame weights */
+  int eg;    /**< score with the endgame weights */
+  int phase; /**< weight of the knights, bishops, rooks and queens left; PHASE_MAX with all of them */
 };
 
-
 /**
  * @brief Structure representing the game board.
+ *
+ * squareSlot maps a square to the piece standing on it, and the position of each piece maps it back to its square.
  */
 struct Board {
   struct Piece pieces[32]; /**< array of pieces */
-  struct Piece squares[8][8]; /**< array of squares */
+  int8_t squareSlot[64]; /**< index in pieces of the piece on each square (SQUARE(x, y)), or NO_PIECE */
+  struct Bitboard bitboard; /**< bitboard view of the position, used by every board query */
+  struct EvalState eval; /**< evaluation terms of the position, kept up to date like the bitboards */
   char* moves[1024]; /**< array of moves */
   int movesIndex;   /**< index of the last move */
 };
@@ -109,6 +112,32 @@ struct Player
   bool canShortCastle; /**< whether the player can short castle */
 };
 
+/** @brief Capacity of the undo stack (number of plies that can be taken back). */
+#define MAX_PLIES 1024
+
+/** @brief Plies after which a game is drawn, leaving room on the undo stack for the computer to search from its last position. */
+#define GAME_MAX_PLIES (MAX_PLIES - 256)
+
+/** @brief Size of the ring of position hashes; a power of two well above the 100 plies of the fifty-move rule. */
+#define HASH_HISTORY 256
+
+/**
+ * @brief Structure representing what make_move needs to take a move back.
+ */
+struct Undo {
+  uint16_t move; /**< encoded move that was made */
+  enum PieceType captured; /**< type of the captured piece, or EMPTY */
+  int8_t capturedSlot; /**< index of the captured piece in board.pieces, or -1 */
+  uint8_t castling; /**< castling rights before the move */
+  int8_t epSquare; /**< en passant square before the move */
+  bool hasMoved; /**< hasMoved flag of the moved piece before the move */
+  int halfmoveClock; /**< halfmove clock before the move */
+  struct AttackInfo info; /**< attack maps, checkers and pins before the move */
+  uint64_t hash; /**< Zobrist hash before the move */
+  uint64_t pawnHash; /**< pawn hash before the move */
+  struct EvalState eval; /**< evaluation terms before the move */
+};
+
 /**
  * @brief Structure representing the game.
  */
@@ -119,6 +148,14 @@ struct Game{
   enum GameStates state;   /**< state of the game */
   uint8_t piece_count; /**< number of pieces */
   bool isWhiteTurn; /**< whether it is white's turn */
+  int halfmoveClock; /**< plies since the last capture or pawn move */
+  int fullmoveNumber; /**< number of the current move, starting at 1 and incremented after black moves */
+  uint64_t hash; /**< Zobrist hash of the position, kept up to date by make_move */
+  uint64_t pawnHash; /**< Zobrist hash of the pawns alone, kept up to date by make_move */
+  uint64_t hashHistory[HASH_HISTORY]; /**< hash of the position after each ply, indexed by ply modulo HASH_HISTORY */
+  struct Undo undoStack[MAX_PLIES]; /**< records of the moves made, oldest first */
+  int undoIndex; /**< number of moves on the undo stack */
+  uint64_t legalTargets[64]; /**< legal destinations of the side to move, per origin square */
 };
 
 /**
@@ -195,17 +232,85 @@ void changeState(struct Game *game, enum GameStates state);
 void changeTurn(struct Game *game);
 
 /**
- * @brief Moves a chess piece on the board.
+ * @brief Moves a chess piece on the board if the move is legal.
  *
  * @param game Pointer to the game instance.
- * @param PieceType The type of the piece.
- * @param piece Pointer to the piece to be moved.
  * @param init_pos Pointer to the initial position of the piece.
  * @param final_pos Pointer to the final position of the piece.
- * 
+ * @return true if the piece was moved, false otherwise.
+ */
+bool move_piece(struct Game *game, struct Position *init_pos, struct Position *final_pos);
+
+/**
+ * @brief Plays an encoded move on the board and pushes its undo record.
+ *
+ * The move must be legal in the current position (e.g. taken from generate_legal_moves).
+ *
+ * @param game Pointer to the game instance.
+ * @param move Encoded move.
+ * @return 0 upon success, 1 if the undo stack is full or no piece stands on the origin square.
+ */
+int make_move(struct Game *game, uint16_t move);
+
+/**
+ * @brief Takes back the last move made with make_move.
+ *
+ * @param game Pointer to the game instance.
+ * @return 0 upon success, 1 if there is no move to take back.
+ */
+int unmake_move(struct Game *game);
+
+/**
+ * @brief Passes the turn without moving (a null move), for the search to test whether the position is good even so.
+ *
+ * @param game Pointer to the game instance; the side to move must not be in check.
+ * @return 0 upon success, 1 if the undo stack is full.
+ */
+int make_null_move(struct Game *game);
+
+/**
+ * @brief Takes back the null move made with make_null_move.
+ *
+ * @param game Pointer to the game instance.
+ * @return 0 upon success, 1 if there is no move to take back.
+ */
+int unmake_null_move(struct Game *game);
+
+/**
+ * @brief Recomputes the legal-destination masks of the side to move.
+ *
+ * @param game Pointer to the game instance.
+ */
+void update_legal_targets(struct Game *game);
+
+/**
+ * @brief Checks if the side to move can legally move a piece between two squares.
+ *
+ * Reads the legal-destination masks only; the board is never modified.
+ *
+ * @param game Pointer to the game instance.
+ * @param init_pos Pointer to the position of the piece.
+ * @param final_pos Pointer to the destination.
+ * @return true if the move is legal, false otherwise.
+ */
+bool is_legal_move(struct Game *game, struct Position *init_pos, struct Position *final_pos);
+
+/**
+ * @brief Plays a move of the game: makes it and refreshes the state of the next turn.
+ *
+ * @param game Pointer to the game instance.
+ * @param move Encoded legal move.
+ * @return 0 upon success, 1 otherwise.
  */
-void move_piece(struct Game *game, enum PieceType PieceType, struct Piece * piece,
-                struct Position *init_pos, struct Position *final_pos);
+int play_move(struct Game *game, uint16_t move);
+
+/**
+ * @brief Checks if the current player is checkmated.
+ *
+ * @param game Pointer to the game instance.
+ * @return true if the current player is checkmated, false otherwise.
+ */
+bool is_checkmate(struct Game *game);
 
 /**
  * @brief Checks if the game is in a stalemate situation.
@@ -216,7 +321,7 @@ void move_piece(struct Game *game, enum PieceType PieceType, struct Piece * piec
 bool is_stalemate(struct Game *game);
 
 /**
- * @brief Checks if the game is in a draw situation.
+ * @brief Checks if the game is in a draw situation because neither player can checkmate.
  *
  * @param game Pointer to the game instance.
  * @return true if the game is in a draw situation, false otherwise.
@@ -224,14 +329,36 @@ bool is_stalemate(struct Game *game);
 bool is_draw(struct Game *game);
 
 /**
- * @brief Retrieves all possible moves for a given piece in the current game state.
- * 
- * @param game A pointer to the Game structure representing the current state of the game.
- * @param piece A pointer to the Piece structure representing the piece for which possible moves need to be determined.
- * 
- * @return A Movelist structure containing a list of possible moves for the given piece.
+ * @brief Classifies the current position (checkmate, stalemate, draw, check or ongoing).
+ *
+ * @param game Pointer to the game instance.
+ * @return The state of the game after the last move.
  */
-struct Movelist get_possible_moves(struct Game *game, struct Piece *piece);
+enum GameStates evaluate_game_state(struct Game *game);
+
+/**
+ * @brief Counts how many times the current position occurred before.
+ *
+ * @param game Pointer to the game instance.
+ * @return Number of earlier occurrences since the last irreversible move.
+ */
+int count_repetitions(struct Game *game);
+
+/**
+ * @brief Checks if the current position occurred for the third time.
+ *
+ * @param game Pointer to the game instance.
+ * @return true if the position is a threefold repetition, false otherwise.
+ */
+bool is_threefold_repetition(struct Game *game);
+
+/**
+ * @brief Checks if fifty moves per side were played without a capture or a pawn move.
+ *
+ * @param game Pointer to the game instance.
+ * @return true if the fifty-move rule applies, false otherwise.
+ */
+bool is_fifty_move_rule(struct Game *game);
 
 /**
  * @brief Creates and initializes a new game board.
@@ -249,18 +376,11 @@ struct Board* create_board();
 void init_board(struct Board *board);
 
 /**
- * @brief Checks if a movement of a specific piece type is legal from an initial position to a final position on the board.
- * 
- * @param board A pointer to the Board structure.
- * @param PieceType The type of the piece.
- * @param piece A pointer to the Piece structure.
- * @param init_pos A pointer to the initial Position structure.
- * @param final_pos A pointer to the final Position structure.
- * @return true if the movement is legal, false otherwise.
+ * @brief Sets a game to the starting position with an empty move history.
+ *
+ * @param game Pointer to the Game structure to be reset.
  */
-bool is_movement_legal(struct Board *board, enum PieceType PieceType, struct Piece * piece, 
-                  struct Position *init_pos , struct Position *final_pos);
-
+void init_position(struct Game *game);
 
 /**
  * @brief Checks if a square on the board is occupied.
@@ -300,37 +420,6 @@ bool is_inside_board(struct Position *pos);
  */
 struct Piece* get_piece_from_click(int click_x, int click_y, int square_size, struct Board* board);
 
-/**
- * @brief Changes the position of a piece on the board from an initial position to a final position.
- * 
- * @param piece A pointer to the Piece structure to be moved.
- * @param init_pos A pointer to the initial Position structure.
- * @param final_pos A pointer to the final Position structure.
- * @param board A pointer to the Board structure.
- * @return true if the piece's position was successfully changed, false otherwise.
- */
-bool change_piece_position(struct Piece *piece,struct Position *init_pos, struct Position *final_pos, struct Board *board);
-
-/**
- * @brief Removes a piece from the board at the specified position.
- * 
- * @param board A pointer to the Board structure.
- * @param pos A pointer to the Position structure indicating the position of the piece to be removed.
- */
-void remove_piece_from_board(struct Board *board, struct Position *pos);
-
-/**
- * @brief Checks if a movement of a specific piece type is legal without actually removing the piece from the board.
- * 
- * @param board A pointer to the Board structure.
- * @param PieceType The type of the piece.
- * @param piece A pointer to the Piece structure.
- * @param init_pos A pointer to the initial Position structure.
- * @param final_pos A pointer to the final Position structure.
- * @return true if the movement is legal, false otherwise.
- */
-bool is_movement_legal_without_removing(struct Board *board, enum PieceType PieceType, struct Piece * piece, struct Position *init_pos , struct Position *final_pos);
-
 /**
  * @brief Checks if the current player is in check.
  * 
@@ -340,10 +429,14 @@ bool is_movement_legal_without_removing(struct Board *board, enum PieceType Piec
 bool is_check(struct Game *game);
 
 /**
- * @brief Promotes a pawn to a queen on the board.
- * 
+ * @brief Whether make_move and unmake_move verify the board after every move (debug and benchmark runs).
+ */
+extern bool board_invariants_enabled;
+
+/**
+ * @brief Checks that the pieces array, the square index and the bitboards describe the same position.
+ *
  * @param board A pointer to the Board structure.
- * @param pawn A pointer to the pawn Piece structure to be promoted.
- * @return The index of the promoted queen in the board's pieces array, or -1 if the promotion fails.
+ * @return 0 if the board is consistent, 1 otherwise.
  */
-int promote_pawn_to_queen(struct Board *board, struct Piece *pawn);
+int verify_board(struct Board *board);
@@ -0,0 +1,496 @@
+/**
+ * @file movegen.c
+ * @brief Implementation of the move generator.
+ *
+ * This file enumerates the moves of the side to move from the attack sets of each piece,
+ * restricted to a target set that depends on what is generated (all moves, captures or
+ * check evasions). Legality is decided with the pinned pieces and the checkers of the
+ * position instead of playing the moves.
+ */
+
+#include "movegen.h"
+
+/**
+ * @brief Kind of moves a generation pass produces.
+ */
+enum GenType {
+  GEN_ALL,      /**< every pseudo-legal move */
+  GEN_CAPTURES, /**< captures and promotions only */
+  GEN_EVASIONS  /**< check evasions only */
+};
+
+/**
+ * @brief Returns the piece type a promotion move promotes to.
+ *
+ * @param move Encoded move, must be a promotion.
+ * @return KNIGHT, BISHOP, ROOK or QUEEN.
+ */
+enum PieceType move_promotion(uint16_t move) {
+  static const enum PieceType promotions[4] = {KNIGHT, BISHOP, ROOK, QUEEN};
+  return promotions[MOVE_FLAGS(move) & 0x3];
+}
+
+/**
+ * @brief Shifts a bitboard by a signed number of squares.
+ *
+ * @param bb The bitboard.
+ * @param delta Positive to shift towards higher squares, negative otherwise.
+ * @return The shifted bitboard.
+ */
+static inline uint64_t shift(uint64_t bb, int delta) {
+  return delta > 0 ? bb << delta : bb >> -delta;
+}
+
+/**
+ * @brief Appends a move to a buffer.
+ *
+ * @param list Buffer the move is written into.
+ * @param from Origin square.
+ * @param to Destination square.
+ * @param flags Move flags.
+ */
+static inline void add_move(struct MoveBuffer *list, int from, int to, int flags) {
+  list->moves[list->index++] = MOVE(from, to, flags);
+}
+
+/**
+ * @brief Appends the four promotions of a pawn move to a buffer.
+ *
+ * @param list Buffer the moves are written into.
+ * @param from Origin square.
+ * @param to Destination square.
+ * @param capture Whether the promotion captures a piece.
+ */
+static void add_promotions(struct MoveBuffer *list, int from, int to, bool capture) {
+  int flags = capture ? MOVE_PROMOTION_CAPTURE : MOVE_PROMOTION;
+  for (int piece = 3; piece >= 0; piece--) {
+    add_move(list, from, to, flags | piece);
+  }
+}
+
+/**
+ * @brief Generates the pawn moves of the side to move that land on a target set.
+ *
+ * Pushes and promotions are generated set-wise by shifting the pawn bitboard, captures by shifting it diagonally.
+ *
+ * @param bb Pointer to the position.
+ * @param list Buffer the moves are written into.
+ * @param type Kind of moves to generate.
+ * @param target Squares the moves may land on (checker and blocking squares when evading).
+ */
+static void generate_pawn_moves(const struct Bitboard *bb, struct MoveBuffer *list, enum GenType type, uint64_t target) {
+  bool white = bb->isWhiteTurn;
+  int up = white ? 8 : -8;
+  int upLeft = white ? 7 : -9;
+  int upRight = white ? 9 : -7;
+  uint64_t pawns = bb->pieces[COLOR(white)][PAWN];
+  uint64_t lastRank = white ? RANK_7 : RANK_2;
+  uint64_t thirdRank = white ? RANK_3 : RANK_6;
+  uint64_t empty = ~bb->occupied;
+  uint64_t enemies = bb->colors[COLOR(!white)] & target;
+  uint64_t promoting = pawns & lastRank;
+  uint64_t others = pawns & ~lastRank;
+
+  if (type != GEN_CAPTURES) {
+    uint64_t single = shift(others, up) & empty;
+    uint64_t twice = shift(single & thirdRank, up) & empty & target;
+    single &= target;
+
+    while (single) {
+      int to = bitboard_pop_lsb(&single);
+      add_move(list, to - up, to, MOVE_QUIET);
+    }
+    while (twice) {
+      int to = bitboard_pop_lsb(&twice);
+      add_move(list, to - 2 * up, to, MOVE_DOUBLE_PUSH);
+    }
+  }
+
+  // promotions change the material like captures do, so GEN_CAPTURES keeps them
+  uint64_t promotions = shift(promoting, up) & empty & (type == GEN_CAPTURES ? ~(uint64_t) 0 : target);
+  while (promotions) {
+    int to = bitboard_pop_lsb(&promotions);
+    add_promotions(list, to - up, to, false);
+  }
+
+  uint64_t left = shift(others & ~FILE_A, upLeft) & enemies;
+  uint64_t right = shift(others & ~FILE_H, upRight) & enemies;
+  while (left) {
+    int to = bitboard_pop_lsb(&left);
+    add_move(list, to - upLeft, to, MOVE_CAPTURE);
+  }
+  while (right) {
+    int to = bitboard_pop_lsb(&right);
+    add_move(list, to - upRight, to, MOVE_CAPTURE);
+  }
+
+  left = shift(promoting & ~FILE_A, upLeft) & enemies;
+  right = shift(promoting & ~FILE_H, upRight) & enemies;
+  while (left) {
+    int to = bitboard_pop_lsb(&left);
+    add_promotions(list, to - upLeft, to, true);
+  }
+  while (right) {
+    int to = bitboard_pop_lsb(&right);
+    add_promotions(list, to - upRight, to, true);
+  }
+
+  if (bb->epSquare != NO_SQUARE) {
+    // when evading, en passant must take the checker or land between it and the king
+    if (type == GEN_EVASIONS && !(target & (SQUARE_BIT(bb->epSquare - up) | SQUARE_BIT(bb->epSquare)))) {
+      return;
+    }
+    uint64_t attackers = others & pawn_attacks(!white, bb->epSquare);
+    while (attackers) {
+      add_move(list, bitboard_pop_lsb(&attackers), bb->epSquare, MOVE_EP_CAPTURE);
+    }
+  }
+}
+
+/**
+ * @brief Generates the moves of the knights, bishops, rooks and queens of the side to move that land on a target set.
+ *
+ * @param bb Pointer to the position.
+ * @param list Buffer the moves are written into.
+ * @param target Squares the moves may land on.
+ */
+static void generate_piece_moves(const struct Bitboard *bb, struct MoveBuffer *list, uint64_t target) {
+  const uint64_t *us = bb->pieces[COLOR(bb->isWhiteTurn)];
+  uint64_t enemies = bb->colors[COLOR(!bb->isWhiteTurn)];
+
+  static const enum PieceType types[4] = {KNIGHT, BISHOP, ROOK, QUEEN};
+
+  for (int i = 0; i < 4; i++) {
+    uint64_t pieces = us[types[i]];
+    while (pieces) {
+      int from = bitboard_pop_lsb(&pieces);
+      uint64_t moves = piece_attacks(types[i], bb->isWhiteTurn, from, bb->occupied) & target;
+      while (moves) {
+        int to = bitboard_pop_lsb(&moves);
+        add_move(list, from, to, (enemies & SQUARE_BIT(to)) ? MOVE_CAPTURE : MOVE_QUIET);
+      }
+    }
+  }
+}
+
+/**
+ * @brief Generates the castling moves of the side to move.
+ *
+ * Castling is only generated when the right is still held, the squares between king and rook are empty, and the king neither stands on, crosses nor lands on an attacked square.
+ *
+ * @param bb Pointer to the position.
+ * @param list Buffer the moves are written into.
+ */
+static void generate_castling(const struct Bitboard *bb, struct MoveBuffer *list) {
+  bool white = bb->isWhiteTurn;
+  int rank = white ? 0 : 7;
+  int king = SQUARE(4, rank);
+  uint8_t shortRight = white ? CASTLING_WHITE_SHORT : CASTLING_BLACK_SHORT;
+  uint8_t longRight = white ? CASTLING_WHITE_LONG : CASTLING_BLACK_LONG;
+
+  uint64_t attacked = bb->info.attacks[COLOR(!white)];
+
+  if (!(bb->castling & (shortRight | longRight)) || bb->info.checkers) {
+    return;
+  }
+
+  if ((bb->castling & shortRight) && !(bb->occupied & between_squares(king, SQUARE(7, rank))) &&
+      !(attacked & (SQUARE_BIT(king + 1) | SQUARE_BIT(king + 2)))) {
+    add_move(list, king, king + 2, MOVE_KING_CASTLE);
+  }
+
+  if ((bb->castling & longRight) && !(bb->occupied & between_squares(king, SQUARE(0, rank))) &&
+      !(attacked & (SQUARE_BIT(king - 1) | SQUARE_BIT(king - 2)))) {
+    add_move(list, king, king - 2, MOVE_QUEEN_CASTLE);
+  }
+}
+
+/**
+ * @brief Runs one generation pass for the side to move.
+ *
+ * This function derives the target set from the kind of moves requested: every square not held by the side to move, the enemy pieces only, or, when evading a single check, the checking piece and the squares between it and the king. A double check leaves only king moves.
+ *
+ * @param bb Pointer to the position.
+ * @param list Buffer the moves are written into.
+ * @param type Kind of moves to generate.
+ * @return Number of moves generated.
+ */
+static int generate(const struct Bitboard *bb, struct MoveBuffer *list, enum GenType type) {
+  bool white = bb->isWhiteTurn;
+  uint64_t own = bb->colors[COLOR(white)];
+  uint64_t king = bb->pieces[COLOR(white)][KING];
+  uint64_t target = type == GEN_CAPTURES ? bb->colors[COLOR(!white)] : ~own;
+
+  list->index = 0;
+  if (king == 0) {
+    return 0;
+  }
+  int ksq = bitboard_lsb(king);
+
+  if (type == GEN_EVASIONS) {
+    uint64_t checkers = bb->info.checkers;
+    if (checkers == 0) {
+      return 0;
+    }
+    if (!(checkers & (checkers - 1))) {
+      int checker = bitboard_lsb(checkers);
+      uint64_t blocks = between_squares(ksq, checker) | checkers;
+      generate_pawn_moves(bb, list, type, blocks);
+      generate_piece_moves(bb, list, blocks & ~own);
+    }
+  }
+  else {
+    generate_pawn_moves(bb, list, type, target);
+    generate_piece_moves(bb, list, target);
+  }
+
+  uint64_t kingMoves = king_attacks(ksq) & target;
+  while (kingMoves) {
+    int to = bitboard_pop_lsb(&kingMoves);
+    add_move(list, ksq, to, (bb->colors[COLOR(!white)] & SQUARE_BIT(to)) ? MOVE_CAPTURE : MOVE_QUIET);
+  }
+
+  if (type == GEN_ALL) {
+    generate_castling(bb, list);
+  }
+  return list->index;
+}
+
+/**
+ * @brief Checks if a pseudo-legal move leaves the own king safe, given the pinned pieces.
+ *
+ * King moves are tested against the enemy attack map, which is built with the king lifted off the board so that it cannot hide behind itself on a checking ray. En passant is tested by replaying the three square changes on the occupancy, since it may uncover a rank attack through both pawns. Any other move is legal unless it moves a pinned piece off its pin line.
+ *
+ * @param bb Pointer to the position.
+ * @param move Encoded pseudo-legal move.
+ * @param pinned Pinned pieces of the side to move.
+ * @return true if the move is legal, false otherwise.
+ */
+static bool legal(const struct Bitboard *bb, uint16_t move, uint64_t pinned) {
+  bool white = bb->isWhiteTurn;
+  const uint64_t *them = bb->pieces[COLOR(!white)];
+  int ksq = bitboard_lsb(bb->pieces[COLOR(white)][KING]);
+  int from = MOVE_FROM(move);
+  int to = MOVE_TO(move);
+
+  if (from == ksq) {
+    if (MOVE_FLAGS(move) == MOVE_KING_CASTLE || MOVE_FLAGS(move) == MOVE_QUEEN_CASTLE) {
+      return true;
+    }
+    return !(bb->info.attacks[COLOR(!white)] & SQUARE_BIT(to));
+  }
+
+  if (MOVE_FLAGS(move) == MOVE_EP_CAPTURE) {
+    int captured = to + (white ? -8 : 8);
+    uint64_t occupied = (bb->occupied ^ SQUARE_BIT(from) ^ SQUARE_BIT(captured)) | SQUARE_BIT(to);
+    return !(rook_attacks(ksq, occupied) & (them[ROOK] | them[QUEEN])) &&
+           !(bishop_attacks(ksq, occupied) & (them[BISHOP] | them[QUEEN]));
+  }
+
+  return !(pinned & SQUARE_BIT(from)) || (line_through(from, to) & SQUARE_BIT(ksq));
+}
+
+/**
+ * @brief Checks if a pseudo-legal move leaves the own king safe.
+ *
+ * This function first rejects, when the side to move is in check, the moves of other pieces that neither capture the checker nor block it, and then applies the pin and king safety tests.
+ *
+ * @param bb Pointer to the position.
+ * @param move Encoded pseudo-legal move.
+ * @return true if the move is legal, false otherwise.
+ */
+bool is_pseudo_legal_move_legal(const struct Bitboard *bb, uint16_t move) {
+  uint64_t king = bb->pieces[COLOR(bb->isWhiteTurn)][KING];
+  if (king == 0) {
+    return false;
+  }
+
+  uint64_t checkers = bb->info.checkers;
+  int ksq = bitboard_lsb(king);
+  if (checkers && MOVE_FROM(move) != ksq && MOVE_FLAGS(move) != MOVE_EP_CAPTURE) {
+    // a piece other than the king must capture the only checker or block its ray
+    if ((checkers & (checkers - 1)) ||
+        !((between_squares(ksq, bitboard_lsb(checkers)) | checkers) & SQUARE_BIT(MOVE_TO(move)))) {
+      return false;
+    }
+  }
+  return legal(bb, move, bb->info.pinned[COLOR(bb->isWhiteTurn)]);
+}
+
+/**
+ * @brief Generates every pseudo-legal move of the side to move.
+ *
+ * @param bb Pointer to the position.
+ * @param list Buffer the moves are written into.
+ * @return Number of moves generated.
+ */
+int generate_pseudo_legal_moves(const struct Bitboard *bb, struct MoveBuffer *list) {
+  return generate(bb, list, GEN_ALL);
+}
+
+/**
+ * @brief Generates every legal move of the side to move.
+ *
+ * This function generates the evasions when the side to move is in check and every pseudo-legal move otherwise, then compacts the buffer in place, keeping only the moves that leave the king safe.
+ *
+ * @param bb Pointer to the position.
+ * @param list Buffer the moves are written into.
+ * @return Number of moves generated.
+ */
+int generate_legal_moves(const struct Bitboard *bb, struct MoveBuffer *list) {
+  generate(bb, list, bb->info.checkers ? GEN_EVASIONS : GEN_ALL);
+  if (list->index == 0) {
+    return 0;
+  }
+
+  uint64_t pinned = bb->info.pinned[COLOR(bb->isWhiteTurn)];
+  int ksq = bitboard_lsb(bb->pieces[COLOR(bb->isWhiteTurn)][KING]);
+  int count = 0;
+
+  for (int i = 0; i < list->index; i++) {
+    uint16_t move = list->moves[i];
+    // only king moves, en passant and moves of pinned pieces can be illegal here
+    if ((!pinned || !(pinned & SQUARE_BIT(MOVE_FROM(move)))) && MOVE_FROM(move) != ksq &&
+        MOVE_FLAGS(move) != MOVE_EP_CAPTURE) {
+      list->moves[count++] = move;
+    }
+    else if (legal(bb, move, pinned)) {
+      list->moves[count++] = move;
+    }
+  }
+  list->index = count;
+  return count;
+}
+
+/**
+ * @brief Checks if the side to move has at least one legal move.
+ *
+ * This function tries the cheapest sources of a move first and returns as soon as one is found: king steps to unattacked squares, then the knights, bishops, rooks and queens, whose destinations are tested set-wise against the target squares and, for pinned pieces, the pin line. Only the pawns go through the generator, since en passant and promotions need the per-move test. Castling never needs a look, because it is impossible when the king has no step to a safe square.
+ *
+ * @param bb Pointer to the position.
+ * @return true if a legal move exists, false otherwise.
+ */
+bool has_legal_move(const struct Bitboard *bb) {
+  bool white = bb->isWhiteTurn;
+  uint64_t own = bb->colors[COLOR(white)];
+  uint64_t king = bb->pieces[COLOR(white)][KING];
+  if (king == 0) {
+    return false;
+  }
+
+  int ksq = bitboard_lsb(king);
+  if (king_attacks(ksq) & ~own & ~bb->info.attacks[COLOR(!white)]) {
+    return true;
+  }
+
+  uint64_t checkers = bb->info.checkers;
+  if (checkers & (checkers - 1)) {
+    return false;
+  }
+
+  uint64_t target = checkers ? (between_squares(ksq, bitboard_lsb(checkers)) | checkers) : ~own;
+  uint64_t pinned = bb->info.pinned[COLOR(white)];
+  static const enum PieceType types[4] = {KNIGHT, BISHOP, ROOK, QUEEN};
+
+  for (int i = 0; i < 4; i++) {
+    uint64_t pieces = bb->pieces[COLOR(white)][types[i]];
+    while (pieces) {
+      int from = bitboard_pop_lsb(&pieces);
+      uint64_t moves = piece_attacks(types[i], white, from, bb->occupied) & target;
+      if (pinned & SQUARE_BIT(from)) {
+        moves &= line_through(from, ksq);
+      }
+      if (moves) {
+        return true;
+      }
+    }
+  }
+
+  struct MoveBuffer list;
+  list.index = 0;
+  generate_pawn_moves(bb, &list, checkers ? GEN_EVASIONS : GEN_ALL, target);
+  for (int i = 0; i < list.index; i++) {
+    if (legal(bb, list.moves[i], pinned)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Generates the pseudo-legal captures and promotions of the side to move (en passant included).
+ *
+ * @param bb Pointer to the position.
+ * @param list Buffer the moves are written into.
+ * @return Number of moves generated.
+ */
+int generate_captures(const struct Bitboard *bb, struct MoveBuffer *list) {
+  return generate(bb, list, GEN_CAPTURES);
+}
+
+/**
+ * @brief Generates the pseudo-legal check evasions of the side to move.
+ *
+ * @param bb Pointer to the position.
+ * @param list Buffer the moves are written into.
+ * @return Number of moves generated.
+ */
+int generate_evasions(const struct Bitboard *bb, struct MoveBuffer *list) {
+  return generate(bb, list, GEN_EVASIONS);
+}
+
+/**
+ * @brief Writes a move in coordinate notation.
+ *
+ * This function writes the origin and destination squares as file letter and rank digit, followed by the lowercase letter of the promotion piece, if any.
+ *
+ * @param move Encoded move.
+ * @param str Buffer of at least 6 characters the null-terminated text is written into.
+ */
+void move_to_string(uint16_t move, char *str) {
+  static const char promotions[4] = {'n', 'b', 'r', 'q'};
+  int from = MOVE_FROM(move);
+  int to = MOVE_TO(move);
+
+  str[0] = 'a' + SQUARE_X(from);
+  str[1] = '1' + SQUARE_Y(from);
+  str[2] = 'a' + SQUARE_X(to);
+  str[3] = '1' + SQUARE_Y(to);
+  str[4] = MOVE_IS_PROMOTION(move) ? promotions[MOVE_FLAGS(move) & 0x3] : '\0';
+  str[5] = '\0';
+}
+
+/**
+ * @brief Finds the legal move of the side to move written in coordinate notation.
+ *
+ * This function decodes the two squares and looks them up among the legal moves, so the flags of the move (capture, castling, en passant) never have to be given.
+ *
+ * @param bb Pointer to the position.
+ * @param str Move in coordinate notation.
+ * @return The encoded move, or NO_MOVE if the text is not a legal move.
+ */
+uint16_t parse_move(const struct Bitboard *bb, const char *str) {
+  if (str[0] < 'a' || str[0] > 'h' || str[1] < '1' || str[1] > '8' ||
+      str[2] < 'a' || str[2] > 'h' || str[3] < '1' || str[3] > '8') {
+    return NO_MOVE;
+  }
+
+  int from = SQUARE(str[0] - 'a', str[1] - '1');
+  int to = SQUARE(str[2] - 'a', str[3] - '1');
+  char promotion = str[4] ? str[4] : 'q';
+  struct MoveBuffer list;
+  char text[6];
+
+  generate_legal_moves(bb, &list);
+  for (int i = 0; i < list.index; i++) {
+    uint16_t move = list.moves[i];
+    if (MOVE_FROM(move) != from || MOVE_TO(move) != to) {
+      continue;
+    }
+    move_to_string(move, text);
+    if (!MOVE_IS_PROMOTION(move) || text[4] == promotion) {
+      return move;
+    }
+  }
+  return NO_MOVE;
+}
@@ -0,0 +1,144 @@
+/**
+ * @file movegen.h
+ * @brief Header file containing the move encoding and the move generator.
+ *
+ * A move is packed in 16 bits: the origin square in bits 0-5, the destination square in
+ * bits 6-11 and a 4-bit flag in bits 12-15 (capture, promotion piece, castling, en passant,
+ * double push). The generator writes encoded moves into a caller-supplied MoveBuffer and
+ * never touches the heap. It reads checkers, pins and attacked squares from the attack
+ * state of the position, which must be up to date (see update_attack_maps()).
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../bitboard/bitboard.h"
+
+#define MOVE_QUIET 0x0            /**< @brief Quiet move */
+#define MOVE_DOUBLE_PUSH 0x1      /**< @brief Pawn moves two squares forward */
+#define MOVE_KING_CASTLE 0x2      /**< @brief King side castling */
+#define MOVE_QUEEN_CASTLE 0x3     /**< @brief Queen side castling */
+#define MOVE_CAPTURE 0x4          /**< @brief Capture */
+#define MOVE_EP_CAPTURE 0x5       /**< @brief En passant capture */
+#define MOVE_PROMOTION 0x8        /**< @brief Promotion (the low two bits give the piece) */
+#define MOVE_PROMOTION_CAPTURE 0xC /**< @brief Promotion with capture (the low two bits give the piece) */
+
+/** @brief Builds an encoded move. */
+#define MOVE(from, to, flags) ((uint16_t) ((from) | ((to) << 6) | ((flags) << 12)))
+
+/** @brief Origin square of an encoded move. */
+#define MOVE_FROM(move) ((move) & 0x3F)
+
+/** @brief Destination square of an encoded move. */
+#define MOVE_TO(move) (((move) >> 6) & 0x3F)
+
+/** @brief Flags of an encoded move. */
+#define MOVE_FLAGS(move) ((move) >> 12)
+
+/** @brief Whether an encoded move captures a piece (en passant included). */
+#define MOVE_IS_CAPTURE(move) ((MOVE_FLAGS(move) & MOVE_CAPTURE) != 0)
+
+/** @brief Whether an encoded move promotes a pawn. */
+#define MOVE_IS_PROMOTION(move) ((MOVE_FLAGS(move) & MOVE_PROMOTION) != 0)
+
+/** @brief Value that never encodes a real move. */
+#define NO_MOVE 0
+
+/** @brief Capacity of a MoveBuffer; no chess position has more legal moves. */
+#define MAX_MOVES 256
+
+/**
+ * @brief Structure representing a fixed-capacity list of encoded moves.
+ */
+struct MoveBuffer {
+  uint16_t moves[MAX_MOVES]; /**< array of encoded moves */
+  int index;                 /**< number of moves in the array */
+};
+
+/**
+ * @brief Returns the piece type a promotion move promotes to.
+ *
+ * @param move Encoded move, must be a promotion.
+ * @return KNIGHT, BISHOP, ROOK or QUEEN.
+ */
+enum PieceType move_promotion(uint16_t move);
+
+/**
+ * @brief Generates every pseudo-legal move of the side to move.
+ *
+ * Moves may leave the own king in check; castling is only generated when it is legal.
+ *
+ * @param bb Pointer to the position.
+ * @param list Buffer the moves are written into.
+ * @return Number of moves generated.
+ */
+int generate_pseudo_legal_moves(const struct Bitboard *bb, struct MoveBuffer *list);
+
+/**
+ * @brief Generates every legal move of the side to move.
+ *
+ * @param bb Pointer to the position.
+ * @param list Buffer the moves are written into.
+ * @return Number of moves generated.
+ */
+int generate_legal_moves(const struct Bitboard *bb, struct MoveBuffer *list);
+
+/**
+ * @brief Generates the pseudo-legal captures and promotions of the side to move (en passant included).
+ *
+ * @param bb Pointer to the position.
+ * @param list Buffer the moves are written into.
+ * @return Number of moves generated.
+ */
+int generate_captures(const struct Bitboard *bb, struct MoveBuffer *list);
+
+/**
+ * @brief Generates the pseudo-legal check evasions of the side to move.
+ *
+ * Only king moves, captures of the checking piece and interpositions are generated.
+ * Nothing is generated when the side to move is not in check.
+ *
+ * @param bb Pointer to the position.
+ * @param list Buffer the moves are written into.
+ * @return Number of moves generated.
+ */
+int generate_evasions(const struct Bitboard *bb, struct MoveBuffer *list);
+
+/**
+ * @brief Checks if the side to move has at least one legal move.
+ *
+ * Stops at the first legal move found, so it is much cheaper than generate_legal_moves
+ * when all that matters is whether the position is checkmate or stalemate.
+ *
+ * @param bb Pointer to the position.
+ * @return true if a legal move exists, false otherwise.
+ */
+bool has_legal_move(const struct Bitboard *bb);
+
+/**
+ * @brief Checks if a pseudo-legal move leaves the own king safe.
+ *
+ * @param bb Pointer to the position.
+ * @param move Encoded pseudo-legal move.
+ * @return true if the move is legal, false otherwise.
+ */
+bool is_pseudo_legal_move_legal(const struct Bitboard *bb, uint16_t move);
+
+/**
+ * @brief Writes a move in coordinate notation (e.g. "e2e4", "e7e8q").
+ *
+ * @param move Encoded move.
+ * @param str Buffer of at least 6 characters the null-terminated text is written into.
+ */
+void move_to_string(uint16_t move, char *str);
+
+/**
+ * @brief Finds the legal move of the side to move written in coordinate notation.
+ *
+ * @param bb Pointer to the position.
+ * @param str Move in coordinate notation; a promotion without a piece letter promotes to a queen.
+ * @return The encoded move, or NO_MOVE if the text is not a legal move.
+ */
+uint16_t parse_move(const struct Bitboard *bb, const char *str);
@@ -0,0 +1,566 @@
+/**
+ * @file perft.c
+ * @brief Implementation of the perft driver.
+ *
+ * This file walks the legal move tree with make_move and unmake_move, so a run checks the
+ * generator and the incremental board updates together, and times each depth to report the
+ * throughput in nodes per second. On the Linux host build the subtrees below the first two plies
+ * can also be counted by a pool of threads, each on its own copy of the game.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#include "perft.h"
+#include "../fen/fen.h"
+#include "../../../utils/timing.h"
+
+/**
+ * @brief Structure representing a reference position of the perft suite.
+ */
+struct PerftPosition {
+  const char *name;                         /**< name printed in the report */
+  const char *fen;                          /**< FEN of the position, or NULL for the starting position */
+  const char *moves;                        /**< moves leading to the position from the FEN position */
+  uint64_t expected[PERFT_MAX_DEPTH + 1];   /**< expected leaf count per depth, 0 if unknown */
+};
+
+/**
+ * @brief Reference positions: the starting position, openings covering castling, en passant, promotions and mates, and
+ * the standard perft test positions, whose published counts stress the same rules in harder cases.
+ */
+static const struct PerftPosition positions[] = {
+  {"start", NULL, NULL, {1, 20, 400, 8902, 197281, 4865609, 119060324}},
+  {"italian", NULL, "e2e4 e7e5 g1f3 b8c6 f1c4 f8c5", {1, 33, 1150, 37139, 1272509, 0, 0}},
+  {"en passant", NULL, "e2e4 d7d5 e4e5 f7f5", {1, 31, 707, 21637, 524138, 0, 0}},
+  {"promotion", NULL, "a2a4 b7b5 a4b5 c7c6 b5c6 d8b6 c6c7 b6b2", {1, 27, 866, 25587, 829761, 0, 0}},
+  {"mate in one", NULL, "e2e4 f7f6 d2d4 g7g5", {1, 37, 715, 26489, 563594, 0, 0}},
+  {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", NULL,
+   {1, 48, 2039, 97862, 4085603, 193690690, 0}},
+  {"position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", NULL, {1, 14, 191, 2812, 43238, 674624, 11030083}},
+  {"position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", NULL,
+   {1, 6, 264, 9467, 422333, 15833292, 706045033}},
+  {"position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", NULL,
+   {1, 44, 1486, 62379, 2103487, 89941194, 0}},
+  {"position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", NULL,
+   {1, 46, 2079, 89890, 3894594, 164075551, 0}},
+};
+
+/**
+ * @brief Structure representing a subtree counted by one worker: the moves leading to it from the root, and its count.
+ */
+struct PerftTask {
+  uint16_t moves[2]; /**< moves from the root to the subtree */
+  int plies;         /**< number of moves used, 1 or 2 */
+  uint64_t nodes;    /**< leaf count of the subtree, filled in by the worker */
+};
+
+/**
+ * @brief Structure representing a parallel perft run shared by its workers.
+ */
+struct PerftJob {
+  const struct Game *root;  /**< position the run starts from */
+  struct PerftTask *tasks;  /**< subtrees to count */
+  int count;                /**< number of tasks */
+  int next;                 /**< index of the next task nobody has taken, advanced atomically */
+  int depth;                /**< depth of the run from the root */
+  struct PerftHash *table;  /**< shared hash table, or NULL */
+};
+
+/** @brief Game the command line runs on; too large for the stack. */
+static struct Game perftGame;
+
+/**
+ * @brief Counts the leaves of the legal move tree of a game.
+ *
+ * This function counts the moves of the last ply without playing them (bulk counting), which is where most of the leaves are.
+ *
+ * @param game Pointer to the game; it is left in the position it was given in.
+ * @param depth Number of plies to explore.
+ * @return Number of leaf nodes.
+ */
+uint64_t perft(struct Game *game, int depth) {
+  struct MoveBuffer list;
+  uint64_t nodes = 0;
+
+  if (depth == 0) {
+    return 1;
+  }
+
+  generate_legal_moves(&game->board.bitboard, &list);
+  if (depth == 1) {
+    return list.index;
+  }
+
+  for (int i = 0; i < list.index; i++) {
+    make_move(game, list.moves[i]);
+    nodes += perft(game, depth - 1);
+    unmake_move(game);
+  }
+  return nodes;
+}
+
+/**
+ * @brief Counts the leaves of the legal move tree of a game, reusing the counts of transposed subtrees.
+ *
+ * This function looks every position at depth 2 or more up in the table before exploring it and stores its count after; depth 1 is cheaper to count than to look up.
+ *
+ * @param game Pointer to the game; it is left in the position it was given in.
+ * @param depth Number of plies to explore.
+ * @param table Pointer to the hash table, or NULL to count every subtree.
+ * @return Number of leaf nodes.
+ */
+uint64_t perft_hashed(struct Game *game, int depth, struct PerftHash *table) {
+  struct MoveBuffer list;
+  uint64_t nodes = 0;
+
+  if (table == NULL || depth < 2) {
+    return perft(game, depth);
+  }
+  if (perft_hash_probe(table, game->hash, depth, &nodes)) {
+    return nodes;
+  }
+
+  generate_legal_moves(&game->board.bitboard, &list);
+  for (int i = 0; i < list.index; i++) {
+    make_move(game, list.moves[i]);
+    nodes += perft_hashed(game, depth - 1, table);
+    unmake_move(game);
+  }
+  perft_hash_store(table, game->hash, depth, nodes);
+  return nodes;
+}
+
+/**
+ * @brief Counts tasks of a parallel run until none is left.
+ *
+ * This function takes tasks by atomically advancing the shared index, so a worker that finishes a small subtree early simply takes the next one instead of waiting for the others.
+ *
+ * @param arg Pointer to the PerftJob.
+ * @return NULL.
+ */
+static void *perft_worker(void *arg) {
+  struct PerftJob *job = (struct PerftJob *) arg;
+  struct Game *game = create_game();
+
+  if (game == NULL) {
+    return NULL;
+  }
+  *game = *job->root;
+
+  for (;;) {
+    int index = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED);
+    if (index >= job->count) {
+      break;
+    }
+
+    struct PerftTask *task = &job->tasks[index];
+    for (int i = 0; i < task->plies; i++) {
+      make_move(game, task->moves[i]);
+    }
+    task->nodes = perft_hashed(game, job->depth - task->plies, job->table);
+    for (int i = 0; i < task->plies; i++) {
+      unmake_move(game);
+    }
+  }
+
+  destroy_game(game);
+  return NULL;
+}
+
+/**
+ * @brief Counts the leaves of the legal move tree of a game with several threads.
+ *
+ * This function splits the tree into one task per root move, or per pair of root move and reply from depth 3 on, which gives the threads hundreds of subtrees to share and keeps them busy until the end. Threads are only created on the Linux host build; elsewhere the tasks are counted by the calling thread.
+ *
+ * @param game Pointer to the game; it is not modified.
+ * @param depth Number of plies to explore.
+ * @param threads Number of threads to count with.
+ * @param table Pointer to the hash table shared by the threads, or NULL.
+ * @return Number of leaf nodes, or 0 if the memory for the tasks could not be allocated.
+ */
+uint64_t perft_parallel(const struct Game *game, int depth, int threads, struct PerftHash *table) {
+  struct Game *root = create_game();
+  struct MoveBuffer list, replies;
+  struct PerftJob job = {root, NULL, 0, 0, depth, table};
+  uint64_t nodes = 0;
+
+  if (root == NULL) {
+    return 0;
+  }
+  *root = *game;
+  if (depth < 2) {
+    nodes = perft(root, depth);
+    destroy_game(root);
+    return nodes;
+  }
+
+  generate_legal_moves(&root->board.bitboard, &list);
+  job.tasks = (struct PerftTask *) malloc(list.index * MAX_MOVES * sizeof(struct PerftTask));
+  if (job.tasks == NULL) {
+    destroy_game(root);
+    return 0;
+  }
+  for (int i = 0; i < list.index; i++) {
+    if (depth < 3) {
+      job.tasks[job.count++] = (struct PerftTask) {{list.moves[i], NO_MOVE}, 1, 0};
+      continue;
+    }
+    make_move(root, list.moves[i]);
+    generate_legal_moves(&root->board.bitboard, &replies);
+    unmake_move(root);
+    for (int j = 0; j < replies.index; j++) {
+      job.tasks[job.count++] = (struct PerftTask) {{list.moves[i], replies.moves[j]}, 2, 0};
+    }
+  }
+
+#ifdef __linux__
+  pthread_t *pool = (pthread_t *) malloc(threads * sizeof(pthread_t));
+  int started = 0;
+  if (pool != NULL) {
+    for (; started < threads - 1; started++) {
+      if (pthread_create(&pool[started], NULL, perft_worker, &job) != 0) {
+        break;
+      }
+    }
+  }
+  perft_worker(&job);
+  for (int i = 0; i < started; i++) {
+    pthread_join(pool[i], NULL);
+  }
+  free(pool);
+#else
+  (void) threads;
+  perft_worker(&job);
+#endif
+
+  for (int i = 0; i < job.count; i++) {
+    nodes += job.tasks[i].nodes;
+  }
+  free(job.tasks);
+  destroy_game(root);
+  return nodes;
+}
+
+/**
+ * @brief Prints how the parallel perft of the starting position scales with the number of threads.
+ *
+ * This function runs the count with 1, 2, 4, ... threads up to the maximum, emptying the hash table before each run so every run does the same work, and prints the time, nodes per second and speedup over one thread.
+ *
+ * @param depth Number of plies to explore.
+ * @param maxThreads Largest number of threads to run with.
+ * @param hashMegabytes Size of the shared hash table, or 0 to run without one.
+ * @return 0 if every run counted the same number of leaves, 1 otherwise.
+ */
+int perft_scaling(int depth, int maxThreads, unsigned hashMegabytes) {
+  struct PerftHash table;
+  struct PerftHash *tablePtr = NULL;
+  uint64_t baseTime = 0;
+  uint64_t baseNodes = 0;
+  int failures = 0;
+
+  if (hashMegabytes > 0) {
+    if (perft_hash_create(&table, hashMegabytes) != 0) {
+      printf("perft: could not allocate %u MB of hash\n", hashMegabytes);
+      return 1;
+    }
+    tablePtr = &table;
+  }
+  perft_setup(&perftGame, NULL, NULL);
+
+  printf("perft depth %d, hash %u MB\n", depth, hashMegabytes);
+  printf("%8s %14s %10s %14s %8s\n", "threads", "nodes", "ms", "nps", "speedup");
+  for (int threads = 1;; threads *= 2) {
+    if (threads > maxThreads) {
+      threads = maxThreads;
+    }
+    if (tablePtr != NULL) {
+      perft_hash_clear(tablePtr);
+    }
+
+    uint64_t start = timing_now_us();
+    uint64_t nodes = perft_parallel(&perftGame, depth, threads, tablePtr);
+    uint64_t elapsed = timing_now_us() - start;
+
+    if (threads == 1) {
+      baseTime = elapsed;
+      baseNodes = nodes;
+    }
+    else if (nodes != baseNodes) {
+      failures++;
+    }
+    printf("%8d %14llu %10llu %14llu %7.2fx%s\n", threads, (unsigned long long) nodes, (unsigned long long) elapsed / 1000,
+           (unsigned long long) timing_per_second(nodes, elapsed), elapsed ? (double) baseTime / elapsed : 0.0,
+           nodes == baseNodes ? "" : " MISMATCH");
+    if (threads == maxThreads) {
+      break;
+    }
+  }
+
+  if (tablePtr != NULL) {
+    perft_hash_destroy(tablePtr);
+  }
+  return failures != 0;
+}
+
+/**
+ * @brief Runs perft and prints the leaf count below every root move.
+ *
+ * Comparing this output with another engine's on the same position narrows a wrong count down to one move, then one subtree at a time.
+ *
+ * @param game Pointer to the game; it is left in the position it was given in.
+ * @param depth Number of plies to explore, at least 1.
+ * @return Total number of leaf nodes.
+ */
+uint64_t perft_divide(struct Game *game, int depth) {
+  struct MoveBuffer list;
+  uint64_t total = 0;
+  char text[6];
+
+  uint64_t start = timing_now_us();
+  generate_legal_moves(&game->board.bitboard, &list);
+  for (int i = 0; i < list.index; i++) {
+    make_move(game, list.moves[i]);
+    uint64_t nodes = perft(game, depth - 1);
+    unmake_move(game);
+
+    move_to_string(list.moves[i], text);
+    printf("%s: %llu\n", text, (unsigned long long) nodes);
+    total += nodes;
+  }
+  uint64_t elapsed = timing_now_us() - start;
+
+  printf("moves %d, nodes %llu, %llu nps\n", list.index, (unsigned long long) total,
+         (unsigned long long) timing_per_second(total, elapsed));
+  return total;
+}
+
+/**
+ * @brief Sets a game to the position reached by playing moves from a FEN position.
+ *
+ * @param game Pointer to the game to be set up.
+ * @param fen FEN of the position to start from, or NULL for the starting position.
+ * @param moves Space-separated moves in coordinate notation, or NULL for none.
+ * @return 0 upon success, 1 if the FEN is rejected or a move is not legal.
+ */
+int perft_setup(struct Game *game, const char *fen, const char *moves) {
+  if (fen == NULL) {
+    init_position(game);
+  }
+  else if (game_from_fen(game, fen) != 0) {
+    printf("perft: invalid FEN \"%s\"\n", fen);
+    return 1;
+  }
+  if (moves == NULL) {
+    return 0;
+  }
+
+  const char *text = moves;
+  while (*text) {
+    if (*text == ' ') {
+      text++;
+      continue;
+    }
+
+    uint16_t move = parse_move(&game->board.bitboard, text);
+    if (move == NO_MOVE) {
+      printf("perft: illegal move in \"%s\"\n", moves);
+      return 1;
+    }
+    make_move(game, move);
+
+    while (*text && *text != ' ') {
+      text++;
+    }
+  }
+  update_legal_targets(game);
+  return 0;
+}
+
+/**
+ * @brief Runs perft on the reference positions and checks the counts against the expected ones.
+ *
+ * This function prints one line per position and depth with the count, the expected count when known and the nodes per second.
+ *
+ * @param maxDepth Deepest depth to run, at most PERFT_MAX_DEPTH.
+ * @return 0 if every count matches, 1 otherwise.
+ */
+int perft_suite(int maxDepth) {
+  int failures = 0;
+  uint64_t totalNodes = 0;
+  uint64_t totalTime = 0;
+
+  if (maxDepth > PERFT_MAX_DEPTH) {
+    maxDepth = PERFT_MAX_DEPTH;
+  }
+
+  for (size_t i = 0; i < sizeof(positions) / sizeof(positions[0]); i++) {
+    const struct PerftPosition *position = &positions[i];
+
+    if (perft_setup(&perftGame, position->fen, position->moves) != 0) {
+      failures++;
+      continue;
+    }
+    if (position->fen != NULL && position->moves == NULL) {
+      char fen[FEN_MAX_LENGTH];
+      game_to_fen(&perftGame, fen);
+      if (strcmp(fen, position->fen) != 0) {
+        printf("%-12s FEN round trip gave \"%s\"\n", position->name, fen);
+        failures++;
+      }
+    }
+
+    for (int depth = 1; depth <= maxDepth; depth++) {
+      uint64_t start = timing_now_us();
+      uint64_t nodes = perft(&perftGame, depth);
+      uint64_t elapsed = timing_now_us() - start;
+      uint64_t expected = position->expected[depth];
+      bool ok = expected == 0 || nodes == expected;
+
+      printf("%-12s depth %d: %12llu %s %llu nps\n", position->name, depth, (unsigned long long) nodes,
+             expected == 0 ? "(unchecked)" : ok ? "OK" : "FAILED", (unsigned long long) timing_per_second(nodes, elapsed));
+      if (!ok) {
+        printf("%-12s expected %llu\n", position->name, (unsigned long long) expected);
+        failures++;
+      }
+      totalNodes += nodes;
+      totalTime += elapsed;
+    }
+  }
+
+  printf("perft: %d failure(s), %llu nodes, %llu nps\n", failures, (unsigned long long) totalNodes,
+         (unsigned long long) timing_per_second(totalNodes, totalTime));
+  perft_fen_benchmark(100000);
+  return failures != 0;
+}
+
+/**
+ * @brief Measures how fast positions are loaded from and saved to FEN.
+ *
+ * This function loads and saves the FEN positions of the suite in turn and prints the number of round trips per second.
+ *
+ * @param rounds Number of round trips.
+ */
+void perft_fen_benchmark(int rounds) {
+  const char *fens[sizeof(positions) / sizeof(positions[0]) + 1];
+  char fen[FEN_MAX_LENGTH];
+  int count = 0;
+
+  fens[count++] = FEN_START;
+  for (size_t i = 0; i < sizeof(positions) / sizeof(positions[0]); i++) {
+    if (positions[i].fen != NULL) {
+      fens[count++] = positions[i].fen;
+    }
+  }
+
+  uint64_t start = timing_now_us();
+  for (int i = 0; i < rounds; i++) {
+    game_from_fen(&perftGame, fens[i % count]);
+    game_to_fen(&perftGame, fen);
+  }
+  uint64_t elapsed = timing_now_us() - start;
+
+  printf("fen: %d round trips, %llu per second\n", rounds, (unsigned long long) timing_per_second(rounds, elapsed));
+}
+
+/**
+ * @brief Checks if a command line argument is a move in coordinate notation rather than part of a FEN.
+ *
+ * @param text The argument.
+ * @return true if the argument looks like a move, false otherwise.
+ */
+static bool is_move_text(const char *text) {
+  size_t length = strlen(text);
+  return (length == 4 || length == 5) && text[0] >= 'a' && text[0] <= 'h' && text[1] >= '1' && text[1] <= '8' &&
+         text[2] >= 'a' && text[2] <= 'h' && text[3] >= '1' && text[3] <= '8';
+}
+
+/**
+ * @brief Joins command line arguments with spaces.
+ *
+ * @param argv Arguments.
+ * @param first Index of the first argument to join.
+ * @param last Index past the last argument to join.
+ * @param buffer Buffer the text is written into.
+ * @param size Size of the buffer.
+ */
+static void join_arguments(char *argv[], int first, int last, char *buffer, size_t size) {
+  buffer[0] = '\0';
+  for (int i = first; i < last; i++) {
+    if (strlen(buffer) + strlen(argv[i]) + 2 > size) {
+      break;
+    }
+    strcat(buffer, argv[i]);
+    strcat(buffer, " ");
+  }
+}
+
+/**
+ * @brief Runs the perft command given on the command line.
+ *
+ * @param argc Number of arguments.
+ * @param argv Arguments, argv[0] being "perft".
+ * @return 0 upon success, 1 otherwise.
+ */
+int perft_command(int argc, char *argv[]) {
+  if (init_bitboard_tables() != 0) {
+    return 1;
+  }
+
+  if (argc >= 3 && strcmp(argv[1], "divide") == 0) {
+    static char fen[FEN_MAX_LENGTH];
+    static char moves[1024];
+    int first = 3;
+    if (argc > 3 && strchr(argv[3], '/') != NULL) {
+      first = 4;
+      while (first < argc && !is_move_text(argv[first])) {
+        first++;
+      }
+      join_arguments(argv, 3, first, fen, sizeof(fen));
+    }
+    join_arguments(argv, first, argc, moves, sizeof(moves));
+    if (perft_setup(&perftGame, first > 3 ? fen : NULL, moves) != 0) {
+      return 1;
+    }
+    int depth = atoi(argv[2]);
+    if (depth < 1) {
+      printf("perft: depth must be at least 1\n");
+      return 1;
+    }
+    perft_divide(&perftGame, depth);
+    return 0;
+  }
+
+  if (argc >= 2 && strcmp(argv[1], "threads") == 0) {
+    int depth = argc > 2 ? atoi(argv[2]) : 6;
+    int maxThreads = argc > 3 ? atoi(argv[3]) : 1;
+#ifdef __linux__
+    if (argc <= 3) {
+      maxThreads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    }
+#endif
+    unsigned hashMegabytes = argc > 4 ? (unsigned) atoi(argv[4]) : 0;
+    if (maxThreads < 1) {
+      maxThreads = 1;
+    }
+    return perft_scaling(depth, maxThreads, hashMegabytes);
+  }
+
+  int arg = 1;
+  if (argc >= 2 && strcmp(argv[1], "check") == 0) {
+    // the start-up check of the magic tables is compiled out of optimized builds
+    if (magic_self_check(PERFT_MAGIC_SAMPLES) != 0) {
+      return 1;
+    }
+    printf("magic tables: %d occupancies per square match the ray walk\n", PERFT_MAGIC_SAMPLES);
+    board_invariants_enabled = true;
+    arg = 2;
+  }
+  int depth = argc > arg ? atoi(argv[arg]) : 4;
+  return perft_suite(depth);
+}
@@ -0,0 +1,109 @@
+/**
+ * @file perft.h
+ * @brief Header file containing the perft driver used to verify and benchmark the move generator.
+ *
+ * Perft counts the leaves of the legal move tree to a fixed depth. The counts of well-known
+ * positions are published, so any mismatch points at a move generation or make/unmake bug,
+ * and the nodes per second give a throughput figure for the whole move pipeline.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "../game.h"
+#include "perft_hash.h"
+
+/** @brief Deepest depth for which the suite stores expected counts. */
+#define PERFT_MAX_DEPTH 6
+
+/** @brief Random occupancies per square and piece type "perft check" compares the magic tables on. */
+#define PERFT_MAGIC_SAMPLES 4096
+
+/**
+ * @brief Counts the leaves of the legal move tree of a game.
+ *
+ * @param game Pointer to the game; it is left in the position it was given in.
+ * @param depth Number of plies to explore.
+ * @return Number of leaf nodes.
+ */
+uint64_t perft(struct Game *game, int depth);
+
+/**
+ * @brief Counts the leaves of the legal move tree of a game, reusing the counts of transposed subtrees.
+ *
+ * @param game Pointer to the game; it is left in the position it was given in.
+ * @param depth Number of plies to explore.
+ * @param table Pointer to the hash table, or NULL to count every subtree.
+ * @return Number of leaf nodes.
+ */
+uint64_t perft_hashed(struct Game *game, int depth, struct PerftHash *table);
+
+/**
+ * @brief Counts the leaves of the legal move tree of a game with several threads (Linux host build only; one thread elsewhere).
+ *
+ * @param game Pointer to the game; it is not modified.
+ * @param depth Number of plies to explore.
+ * @param threads Number of threads to count with.
+ * @param table Pointer to the hash table shared by the threads, or NULL.
+ * @return Number of leaf nodes, or 0 if the memory for the tasks could not be allocated.
+ */
+uint64_t perft_parallel(const struct Game *game, int depth, int threads, struct PerftHash *table);
+
+/**
+ * @brief Prints how the parallel perft of the starting position scales with the number of threads.
+ *
+ * @param depth Number of plies to explore.
+ * @param maxThreads Largest number of threads to run with.
+ * @param hashMegabytes Size of the shared hash table, or 0 to run without one.
+ * @return 0 if every run counted the same number of leaves, 1 otherwise.
+ */
+int perft_scaling(int depth, int maxThreads, unsigned hashMegabytes);
+
+/**
+ * @brief Runs perft and prints the leaf count below every root move.
+ *
+ * @param game Pointer to the game; it is left in the position it was given in.
+ * @param depth Number of plies to explore, at least 1.
+ * @return Total number of leaf nodes.
+ */
+uint64_t perft_divide(struct Game *game, int depth);
+
+/**
+ * @brief Sets a game to the position reached by playing moves from a FEN position.
+ *
+ * @param game Pointer to the game to be set up.
+ * @param fen FEN of the position to start from, or NULL for the starting position.
+ * @param moves Space-separated moves in coordinate notation, or NULL for none.
+ * @return 0 upon success, 1 if the FEN is rejected or a move is not legal.
+ */
+int perft_setup(struct Game *game, const char *fen, const char *moves);
+
+/**
+ * @brief Runs perft on the reference positions and checks the counts against the expected ones.
+ *
+ * @param maxDepth Deepest depth to run, at most PERFT_MAX_DEPTH.
+ * @return 0 if every count matches, 1 otherwise.
+ */
+int perft_suite(int maxDepth);
+
+/**
+ * @brief Measures how fast positions are loaded from and saved to FEN.
+ *
+ * @param rounds Number of round trips.
+ */
+void perft_fen_benchmark(int rounds);
+
+/**
+ * @brief Runs the perft command given on the command line.
+ *
+ * Accepted forms: "perft [depth]" runs the suite, "perft check [depth]" checks the magic tables
+ * against the ray walk then runs it with the board invariants verified after every move, "perft divide <depth> [fen] [moves...]" divides from the
+ * position reached by the moves, and "perft threads [depth] [maxThreads] [hashMB]" prints the
+ * thread scaling table.
+ *
+ * @param argc Number of arguments.
+ * @param argv Arguments, argv[0] being "perft".
+ * @return 0 upon success, 1 otherwise.
+ */
+int perft_command(int argc, char *argv[]);
@@ -0,0 +1,97 @@
+/**
+ * @file perft_hash.c
+ * @brief Implementation of the hash table perft uses to count transposed subtrees once.
+ *
+ * The words of an entry are read and written with relaxed atomic accesses, which compile to
+ * plain loads and stores; the XOR check is what keeps concurrent readers and writers consistent.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "perft_hash.h"
+
+/**
+ * @brief Allocates a perft hash table.
+ *
+ * This function sizes the table to the largest power of two number of entries that fits in the given size, so a slot is found by masking the hash.
+ *
+ * @param table Pointer to the table to be set up.
+ * @param megabytes Size of the table; rounded down to a power of two number of slots.
+ * @return 0 upon success, 1 if the memory could not be allocated.
+ */
+int perft_hash_create(struct PerftHash *table, unsigned megabytes) {
+  uint64_t bytes = (uint64_t) megabytes << 20;
+  uint64_t count = 1;
+
+  while (count * 2 * sizeof(struct PerftEntry) <= bytes) {
+    count *= 2;
+  }
+
+  table->entries = (struct PerftEntry *) calloc(count, sizeof(struct PerftEntry));
+  if (table->entries == NULL) {
+    table->mask = 0;
+    return 1;
+  }
+  table->mask = count - 1;
+  return 0;
+}
+
+/**
+ * @brief Frees the memory of a perft hash table.
+ *
+ * @param table Pointer to the table.
+ */
+void perft_hash_destroy(struct PerftHash *table) {
+  free(table->entries);
+  table->entries = NULL;
+  table->mask = 0;
+}
+
+/**
+ * @brief Empties a perft hash table.
+ *
+ * An all-zero entry never matches, since a stored depth is always at least 1.
+ *
+ * @param table Pointer to the table.
+ */
+void perft_hash_clear(struct PerftHash *table) {
+  memset(table->entries, 0, (table->mask + 1) * sizeof(struct PerftEntry));
+}
+
+/**
+ * @brief Looks up the leaf count of a position at a depth.
+ *
+ * @param table Pointer to the table.
+ * @param hash Zobrist hash of the position.
+ * @param depth Depth of the count.
+ * @param nodes Pointer to where the count is written on a hit.
+ * @return true on a hit, false otherwise.
+ */
+bool perft_hash_probe(const struct PerftHash *table, uint64_t hash, int depth, uint64_t *nodes) {
+  const struct PerftEntry *entry = &table->entries[hash & table->mask];
+  uint64_t data = __atomic_load_n(&entry->data, __ATOMIC_RELAXED);
+  uint64_t check = __atomic_load_n(&entry->check, __ATOMIC_RELAXED);
+
+  if ((check ^ data) != hash || (int) (data & 0xff) != depth) {
+    return false;
+  }
+  *nodes = data >> 8;
+  return true;
+}
+
+/**
+ * @brief Stores the leaf count of a position at a depth, replacing whatever the slot held.
+ *
+ * @param table Pointer to the table.
+ * @param hash Zobrist hash of the position.
+ * @param depth Depth of the count.
+ * @param nodes Leaf count.
+ */
+void perft_hash_store(struct PerftHash *table, uint64_t hash, int depth, uint64_t nodes) {
+  struct PerftEntry *entry = &table->entries[hash & table->mask];
+  uint64_t data = nodes << 8 | (uint64_t) depth;
+
+  __atomic_store_n(&entry->data, data, __ATOMIC_RELAXED);
+  __atomic_store_n(&entry->check, hash ^ data, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,73 @@
+/**
+ * @file perft_hash.h
+ * @brief Header file containing the hash table perft uses to count transposed subtrees once.
+ *
+ * Each entry stores the leaf count of a (position, depth) pair. The table has no locks: an entry
+ * is two 64-bit words, the count and the position hash XOR-ed with the count, so a read that
+ * sees half of one write and half of another fails the check and is treated as a miss.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Structure representing one slot of the perft hash table.
+ */
+struct PerftEntry {
+  uint64_t check; /**< position hash XOR-ed with data */
+  uint64_t data;  /**< leaf count in the high 56 bits, depth in the low 8 bits */
+};
+
+/**
+ * @brief Structure representing the perft hash table.
+ */
+struct PerftHash {
+  struct PerftEntry *entries; /**< slots, a power of two of them */
+  uint64_t mask;              /**< number of slots minus one */
+};
+
+/**
+ * @brief Allocates a perft hash table.
+ *
+ * @param table Pointer to the table to be set up.
+ * @param megabytes Size of the table; rounded down to a power of two number of slots.
+ * @return 0 upon success, 1 if the memory could not be allocated.
+ */
+int perft_hash_create(struct PerftHash *table, unsigned megabytes);
+
+/**
+ * @brief Frees the memory of a perft hash table.
+ *
+ * @param table Pointer to the table.
+ */
+void perft_hash_destroy(struct PerftHash *table);
+
+/**
+ * @brief Empties a perft hash table.
+ *
+ * @param table Pointer to the table.
+ */
+void perft_hash_clear(struct PerftHash *table);
+
+/**
+ * @brief Looks up the leaf count of a position at a depth.
+ *
+ * @param table Pointer to the table.
+ * @param hash Zobrist hash of the position.
+ * @param depth Depth of the count.
+ * @param nodes Pointer to where the count is written on a hit.
+ * @return true on a hit, false otherwise.
+ */
+bool perft_hash_probe(const struct PerftHash *table, uint64_t hash, int depth, uint64_t *nodes);
+
+/**
+ * @brief Stores the leaf count of a position at a depth, replacing whatever the slot held.
+ *
+ * @param table Pointer to the table.
+ * @param hash Zobrist hash of the position.
+ * @param depth Depth of the count.
+ * @param nodes Leaf count.
+ */
+void perft_hash_store(struct PerftHash *table, uint64_t hash, int depth, uint64_t nodes);
@@ -0,0 +1,899 @@
+/**
+ * @file bitbase.c
+ * @brief Implementation of the bitbases of the most common endings, and of their generator.
+ *
+ * Positions are always seen from the side with the pieces, called the strong side, as white: a
+ * position where black has the pieces is probed with its ranks mirrored. The index of a position
+ * is its side to move, the squares of the strong and of the weak king, then the squares of the
+ * strong pieces, six bits each, with no symmetry folded away; squares that collide, kings that
+ * touch and the like simply give illegal indices.
+ *
+ * The generator starts from the positions the weak side has lost with no move to make (the
+ * mates) and those the strong side wins at once by promoting, then walks the moves backwards
+ * one round at a time. A position of the strong side to move is won as soon as one of its moves
+ * reaches a lost position; a position of the weak side to move is lost once all its moves
+ * reach won ones, which a counter of the moves not yet known to lose tracks. The weak king
+ * taking a piece leaves too little to mate with, so a position where it can is drawn whatever
+ * its other moves. Every position is worked on by one thread per slice of the table; a thread
+ * reaching into the slice of another one does so with atomic operations only.
+ *
+ * The file holds, per ending, a table of blocks of BITBASE_BLOCK_POSITIONS positions: the bit
+ * shared by all the legal positions of a block when it is uniform, or else the position of its
+ * bits. It is written in the byte order of the machine, little-endian on every target of the
+ * program, so that a loaded file is used in place.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#include "bitbase.h"
+#include "../../../utils/timing.h"
+
+/** @brief First bytes of a bitbase file. */
+static const uint8_t bitbase_magic[4] = {'L', 'C', 'B', 'B'};
+
+/** @brief Version of the file format. */
+#define BITBASE_VERSION 1
+
+/** @brief Size of the header of a bitbase file: magic, version and number of tables. */
+#define BITBASE_HEADER_SIZE 12
+
+/** @brief Size of the entry of a table in the header: name, number of blocks, offset of the blocks, offset of the bits and number of raw blocks. */
+#define BITBASE_TABLE_SIZE 24
+
+/** @brief Longest name of an ending, null terminator included. */
+#define BITBASE_NAME_LENGTH 8
+
+/** @brief Kind of a block whose legal positions are all drawn. */
+#define BITBASE_BLOCK_ZERO 0u
+
+/** @brief Kind of a block whose legal positions are all won by the strong side. */
+#define BITBASE_BLOCK_ONE 1u
+
+/** @brief Kind of a block stored bit by bit. */
+#define BITBASE_BLOCK_RAW 2u
+
+/** @brief Words of the bits of a block. */
+#define BITBASE_BLOCK_WORDS (BITBASE_BLOCK_POSITIONS / 64)
+
+/** @brief Counter of a position of the weak side to move that can never be lost: illegal, stalemate or with a capture. */
+#define BITBASE_DRAWN 0xFF
+
+/** @brief Most strong pieces besides the king. */
+#define BITBASE_MAX_PIECES 2
+
+/**
+ * @brief Structure representing the material of an ending.
+ */
+struct BitbaseMaterial {
+  const char *name;                           /**< name of the ending in the file */
+  int count;                                  /**< number of strong pieces besides the king */
+  enum PieceType types[BITBASE_MAX_PIECES];   /**< types of those pieces, each appearing once */
+};
+
+/** @brief Material of each ending, in the order of enum BitbaseEnding, which is also the order they are generated in. */
+static const struct BitbaseMaterial bitbase_materials[BITBASE_ENDINGS] = {
+  {"KQK", 1, {QUEEN}},
+  {"KRK", 1, {ROOK}},
+  {"KPK", 1, {PAWN}},
+  {"KBNK", 2, {BISHOP, KNIGHT}},
+};
+
+/**
+ * @brief Structure representing a position of an ending, the strong side being white.
+ */
+struct BitbasePosition {
+  bool weakToMove;                     /**< whether the lone king is to move */
+  int strongKing;                      /**< square of the king of the strong side */
+  int weakKing;                        /**< square of the lone king */
+  int squares[BITBASE_MAX_PIECES];     /**< squares of the strong pieces, in the order of the material */
+  uint64_t occupied;                   /**< occupied squares */
+};
+
+/**
+ * @brief Structure representing the generation of the bitbase of one ending.
+ */
+struct BitbaseGenerator {
+  const struct BitbaseMaterial *material; /**< material of the ending */
+  uint32_t positions;                     /**< number of indices, both sides to move */
+  uint64_t *wins;                         /**< per position, whether the strong side wins */
+  uint64_t *fresh;                        /**< positions found won in the last round, whose predecessors this round visits */
+  uint64_t *next;                         /**< positions found won in this round */
+  uint8_t *counters;                      /**< per position of the weak side to move, its moves not yet known to lose, or BITBASE_DRAWN */
+  const uint64_t *promotions[2];          /**< wins of KQK and KRK, for the promotions of KPK */
+  int threads;                            /**< number of threads */
+};
+
+/**
+ * @brief Structure representing the share of a generation step one thread works on.
+ */
+struct BitbaseWorker {
+  struct BitbaseGenerator *generator;                                     /**< the generation */
+  void (*task)(struct BitbaseGenerator *, uint32_t first, uint32_t last); /**< step run on the share */
+  uint32_t first;                                                         /**< first word of the share */
+  uint32_t last;                                                          /**< word after the share */
+#ifdef __linux__
+  pthread_t thread;                                                       /**< the thread */
+#endif
+};
+
+struct Bitbases bitbases;
+
+/**
+ * @brief Returns the number of indices of an ending.
+ *
+ * @param material Material of the ending.
+ * @return Number of indices, both sides to move.
+ */
+static uint32_t bitbase_positions(const struct BitbaseMaterial *material) {
+  return 2u << (6 * (2 + material->count));
+}
+
+/**
+ * @brief Computes the index of a position.
+ *
+ * @param material Material of the ending.
+ * @param pos Pointer to the position.
+ * @return Index of the position.
+ */
+static uint32_t bitbase_index(const struct BitbaseMaterial *material, const struct BitbasePosition *pos) {
+  uint32_t index = pos->weakToMove;
+  index = (index << 6) | pos->strongKing;
+  index = (index << 6) | pos->weakKing;
+  for (int i = 0; i < material->count; i++) {
+    index = (index << 6) | pos->squares[i];
+  }
+  return index;
+}
+
+/**
+ * @brief Decodes the position of an index.
+ *
+ * @param material Material of the ending.
+ * @param index Index of the position.
+ * @param pos Filled with the position.
+ */
+static void bitbase_decode(const struct BitbaseMaterial *material, uint32_t index, struct BitbasePosition *pos) {
+  pos->occupied = 0;
+  for (int i = material->count - 1; i >= 0; i--) {
+    pos->squares[i] = index & 63;
+    pos->occupied |= 1ULL << pos->squares[i];
+    index >>= 6;
+  }
+  pos->weakKing = index & 63;
+  pos->strongKing = (index >> 6) & 63;
+  pos->weakToMove = (index >> 12) & 1;
+  pos->occupied |= (1ULL << pos->weakKing) | (1ULL << pos->strongKing);
+}
+
+/**
+ * @brief Returns the squares the strong side attacks.
+ *
+ * @param material Material of the ending.
+ * @param pos Pointer to the position.
+ * @param occupied Occupancy used for the sliding pieces.
+ * @param skip Index of a piece to leave out, having been taken, or -1.
+ * @return Attack set.
+ */
+static uint64_t strong_attacks(const struct BitbaseMaterial *material, const struct BitbasePosition *pos, uint64_t occupied, int skip) {
+  uint64_t attacks = king_attacks(pos->strongKing);
+  for (int i = 0; i < material->count; i++) {
+    if (i != skip) {
+      attacks |= piece_attacks(material->types[i], true, pos->squares[i], occupied);
+    }
+  }
+  return attacks;
+}
+
+/**
+ * @brief Checks if a position can arise in a game.
+ *
+ * @param material Material of the ending.
+ * @param pos Pointer to the position.
+ * @return true if every piece has its own square, the kings do not touch, no pawn stands on the first or last rank and the side not to move is not in check, false otherwise.
+ */
+static bool bitbase_legal(const struct BitbaseMaterial *material, const struct BitbasePosition *pos) {
+  if (bitboard_count(pos->occupied) != 2 + material->count || (king_attacks(pos->strongKing) & (1ULL << pos->weakKing))) {
+    return false;
+  }
+  for (int i = 0; i < material->count; i++) {
+    if (material->types[i] == PAWN && ((1ULL << pos->squares[i]) & (RANK_1 | RANK_8))) {
+      return false;
+    }
+  }
+  return pos->weakToMove || !(strong_attacks(material, pos, pos->occupied, -1) & (1ULL << pos->weakKing));
+}
+
+/**
+ * @brief Marks a position as won by the strong side, unless it already is.
+ *
+ * @param gen Pointer to the generation.
+ * @param index Index of the position.
+ */
+static void bitbase_set_win(struct BitbaseGenerator *gen, uint32_t index) {
+  uint64_t bit = 1ULL << (index & 63);
+  if (!(__atomic_fetch_or(&gen->wins[index >> 6], bit, __ATOMIC_RELAXED) & bit)) {
+    __atomic_fetch_or(&gen->next[index >> 6], bit, __ATOMIC_RELAXED);
+  }
+}
+
+/**
+ * @brief Sets up a position of the weak side to move: counts its moves, and marks it as lost if it is mated.
+ *
+ * @param gen Pointer to the generation.
+ * @param index Index of the position.
+ * @param pos Pointer to the position, legal.
+ */
+static void bitbase_init_weak(struct BitbaseGenerator *gen, uint32_t index, const struct BitbasePosition *pos) {
+  const struct BitbaseMaterial *material = gen->material;
+  uint64_t occupied = pos->occupied & ~(1ULL << pos->weakKing);
+  uint64_t targets = king_attacks(pos->weakKing) & ~king_attacks(pos->strongKing);
+  uint8_t *counter = &gen->counters[index - gen->positions / 2];
+  int moves = 0;
+
+  while (targets) {
+    int to = bitboard_pop_lsb(&targets);
+    int captured = -1;
+    for (int i = 0; i < material->count; i++) {
+      if (pos->squares[i] == to) {
+        captured = i;
+      }
+    }
+    if (strong_attacks(material, pos, occupied, captured) & (1ULL << to)) {
+      continue;
+    }
+    if (captured >= 0) {
+      *counter = BITBASE_DRAWN;
+      return;
+    }
+    moves++;
+  }
+
+  if (moves > 0) {
+    *counter = moves;
+    return;
+  }
+  *counter = BITBASE_DRAWN;
+  if (strong_attacks(material, pos, pos->occupied, -1) & (1ULL << pos->weakKing)) {
+    bitbase_set_win(gen, index);
+  }
+}
+
+/**
+ * @brief Sets up a position of the strong side to move: marks it as won if a promotion reaches a lost position of KQK or KRK.
+ *
+ * Promoting to a knight or a bishop leaves too little to mate with, so only the queen and the rook are tried.
+ *
+ * @param gen Pointer to the generation.
+ * @param index Index of the position.
+ * @param pos Pointer to the position, legal.
+ */
+static void bitbase_init_strong(struct BitbaseGenerator *gen, uint32_t index, const struct BitbasePosition *pos) {
+  if (gen->material->types[0] != PAWN || !((1ULL << pos->squares[0]) & RANK_7) || (pos->occupied & (1ULL << (pos->squares[0] + 8)))) {
+    return;
+  }
+  for (int i = 0; i < 2; i++) {
+    struct BitbasePosition promoted = *pos;
+    promoted.weakToMove = true;
+    promoted.squares[0] += 8;
+    uint32_t target = bitbase_index(&bitbase_materials[i == 0 ? BITBASE_KQK : BITBASE_KRK], &promoted);
+    if (gen->promotions[i][target >> 6] & (1ULL << (target & 63))) {
+      bitbase_set_win(gen, index);
+      return;
+    }
+  }
+}
+
+/**
+ * @brief Sets up the positions of a share of the table.
+ *
+ * @param gen Pointer to the generation.
+ * @param first First word of the share.
+ * @param last Word after the share.
+ */
+static void bitbase_init_task(struct BitbaseGenerator *gen, uint32_t first, uint32_t last) {
+  uint32_t half = gen->positions / 2;
+  for (uint32_t index = first * 64; index < last * 64; index++) {
+    struct BitbasePosition pos;
+    bitbase_decode(gen->material, index, &pos);
+    if (!bitbase_legal(gen->material, &pos)) {
+      if (index >= half) {
+        gen->counters[index - half] = BITBASE_DRAWN;
+      }
+    }
+    else if (pos.weakToMove) {
+      bitbase_init_weak(gen, index, &pos);
+    }
+    else {
+      bitbase_init_strong(gen, index, &pos);
+    }
+  }
+}
+
+/**
+ * @brief Visits the positions of the weak side to move that reach a won position by a king move, and marks those with no move left as lost.
+ *
+ * @param gen Pointer to the generation.
+ * @param pos Pointer to the won position, with the strong side to move.
+ */
+static void bitbase_unmove_weak(struct BitbaseGenerator *gen, const struct BitbasePosition *pos) {
+  uint64_t origins = king_attacks(pos->weakKing) & ~pos->occupied & ~king_attacks(pos->strongKing);
+  uint32_t half = gen->positions / 2;
+  struct BitbasePosition previous = *pos;
+  previous.weakToMove = true;
+
+  while (origins) {
+    previous.weakKing = bitboard_pop_lsb(&origins);
+    uint32_t index = bitbase_index(gen->material, &previous);
+    uint8_t *counter = &gen->counters[index - half];
+    if (__atomic_load_n(counter, __ATOMIC_RELAXED) != BITBASE_DRAWN && __atomic_sub_fetch(counter, 1, __ATOMIC_RELAXED) == 0) {
+      bitbase_set_win(gen, index);
+    }
+  }
+}
+
+/**
+ * @brief Marks as won the legal positions of the strong side to move that reach a lost position by moving a piece.
+ *
+ * @param gen Pointer to the generation.
+ * @param pos Pointer to the previous position with the moved piece put back, except for its occupancy.
+ * @param piece Index of the moved piece, or -1 for the king.
+ * @param origins Squares the piece may have come from.
+ */
+static void bitbase_unmove_piece(struct BitbaseGenerator *gen, struct BitbasePosition *pos, int piece, uint64_t origins) {
+  int *square = piece < 0 ? &pos->strongKing : &pos->squares[piece];
+  int to = *square;
+  uint64_t occupied = pos->occupied;
+
+  while (origins) {
+    *square = bitboard_pop_lsb(&origins);
+    pos->occupied = (occupied & ~(1ULL << to)) | (1ULL << *square);
+    if (bitbase_legal(gen->material, pos)) {
+      bitbase_set_win(gen, bitbase_index(gen->material, pos));
+    }
+  }
+  *square = to;
+  pos->occupied = occupied;
+}
+
+/**
+ * @brief Marks as won the positions of the strong side to move that reach a lost position.
+ *
+ * @param gen Pointer to the generation.
+ * @param pos Pointer to the lost position, with the weak side to move.
+ */
+static void bitbase_unmove_strong(struct BitbaseGenerator *gen, const struct BitbasePosition *pos) {
+  const struct BitbaseMaterial *material = gen->material;
+  struct BitbasePosition previous = *pos;
+  previous.weakToMove = false;
+
+  bitbase_unmove_piece(gen, &previous, -1, king_attacks(pos->strongKing) & ~pos->occupied & ~king_attacks(pos->weakKing));
+  for (int i = 0; i < material->count; i++) {
+    int to = pos->squares[i];
+    uint64_t origins;
+    if (material->types[i] == PAWN) {
+      // a pawn comes from one square behind, or from its starting square two behind
+      origins = to >= 16 ? (1ULL << (to - 8)) & ~pos->occupied : 0;
+      if (origins && (to >> 3) == 3) {
+        origins |= (1ULL << (to - 16)) & ~pos->occupied;
+      }
+    }
+    else {
+      origins = piece_attacks(material->types[i], true, to, pos->occupied) & ~pos->occupied;
+    }
+    bitbase_unmove_piece(gen, &previous, i, origins);
+  }
+}
+
+/**
+ * @brief Visits the predecessors of the positions of a share of the table found won in the last round.
+ *
+ * @param gen Pointer to the generation.
+ * @param first First word of the share.
+ * @param last Word after the share.
+ */
+static void bitbase_round_task(struct BitbaseGenerator *gen, uint32_t first, uint32_t last) {
+  for (uint32_t word = first; word < last; word++) {
+    uint64_t bits = gen->fresh[word];
+    while (bits) {
+      struct BitbasePosition pos;
+      bitbase_decode(gen->material, word * 64 + bitboard_pop_lsb(&bits), &pos);
+      if (pos.weakToMove) {
+        bitbase_unmove_strong(gen, &pos);
+      }
+      else {
+        bitbase_unmove_weak(gen, &pos);
+      }
+    }
+  }
+}
+
+#ifdef __linux__
+/**
+ * @brief Runs the step of a worker on its share.
+ *
+ * @param arg Pointer to the BitbaseWorker.
+ * @return NULL.
+ */
+static void *bitbase_worker(void *arg) {
+  struct BitbaseWorker *worker = (struct BitbaseWorker *) arg;
+  worker->task(worker->generator, worker->first, worker->last);
+  return NULL;
+}
+#endif
+
+/**
+ * @brief Runs a generation step over the whole table, split in equal shares among the threads.
+ *
+ * The calling thread takes the first share; a share whose thread cannot be started is run by the calling thread too.
+ *
+ * @param gen Pointer to the generation.
+ * @param task Step to run.
+ */
+static void bitbase_run(struct BitbaseGenerator *gen, void (*task)(struct BitbaseGenerator *, uint32_t first, uint32_t last)) {
+  struct BitbaseWorker workers[BITBASE_MAX_THREADS];
+  uint32_t words = gen->positions / 64;
+
+  for (int i = 0; i < gen->threads; i++) {
+    workers[i].generator = gen;
+    workers[i].task = task;
+    workers[i].first = (uint32_t) ((uint64_t) words * i / gen->threads);
+    workers[i].last = (uint32_t) ((uint64_t) words * (i + 1) / gen->threads);
+  }
+
+#ifdef __linux__
+  bool started[BITBASE_MAX_THREADS] = {false};
+  for (int i = 1; i < gen->threads; i++) {
+    started[i] = pthread_create(&workers[i].thread, NULL, bitbase_worker, &workers[i]) == 0;
+  }
+#endif
+  task(gen, workers[0].first, workers[0].last);
+  for (int i = 1; i < gen->threads; i++) {
+#ifdef __linux__
+    if (started[i]) {
+      pthread_join(workers[i].thread, NULL);
+      continue;
+    }
+#endif
+    task(gen, workers[i].first, workers[i].last);
+  }
+}
+
+/**
+ * @brief Generates the bitbase of one ending.
+ *
+ * @param gen Pointer to the generation, whose material, positions, wins, promotions and threads are set and whose wins are cleared.
+ * @return 0 upon success, 1 if memory could not be allocated.
+ */
+static int bitbase_solve(struct BitbaseGenerator *gen) {
+  uint32_t words = gen->positions / 64;
+  uint64_t start = timing_now_us();
+  int rounds = 0;
+
+  gen->fresh = calloc(words, sizeof(uint64_t));
+  gen->next = calloc(words, sizeof(uint64_t));
+  gen->counters = malloc(gen->positions / 2);
+  if (gen->fresh == NULL || gen->next == NULL || gen->counters == NULL) {
+    free(gen->fresh);
+    free(gen->next);
+    free(gen->counters);
+    return 1;
+  }
+
+  bitbase_run(gen, bitbase_init_task);
+  for (;;) {
+    uint64_t *swap = gen->fresh;
+    gen->fresh = gen->next;
+    gen->next = swap;
+    memset(gen->next, 0, words * sizeof(uint64_t));
+
+    bool found = false;
+    for (uint32_t i = 0; i < words && !found; i++) {
+      found = gen->fresh[i] != 0;
+    }
+    if (!found) {
+      break;
+    }
+    bitbase_run(gen, bitbase_round_task);
+    rounds++;
+  }
+
+  uint64_t legal[2] = {0, 0};
+  uint64_t won[2] = {0, 0};
+  for (uint32_t index = 0; index < gen->positions; index++) {
+    struct BitbasePosition pos;
+    bitbase_decode(gen->material, index, &pos);
+    if (bitbase_legal(gen->material, &pos)) {
+      legal[pos.weakToMove]++;
+      won[pos.weakToMove] += (gen->wins[index >> 6] >> (index & 63)) & 1;
+    }
+  }
+  printf("%-5s %2d rounds %6llu ms: strong side to move wins %llu of %llu, weak side to move loses %llu of %llu\n",
+         gen->material->name, rounds, (unsigned long long) ((timing_now_us() - start) / 1000),
+         (unsigned long long) won[0], (unsigned long long) legal[0], (unsigned long long) won[1], (unsigned long long) legal[1]);
+
+  free(gen->fresh);
+  free(gen->next);
+  free(gen->counters);
+  return 0;
+}
+
+/**
+ * @brief Writes a 32-bit number to a file.
+ *
+ * @param stream The file.
+ * @param value The number.
+ * @return 0 upon success, 1 otherwise.
+ */
+static int write_u32(FILE *stream, uint32_t value) {
+  return fwrite(&value, sizeof(value), 1, stream) == 1 ? 0 : 1;
+}
+
+/**
+ * @brief Compresses the bitbase of one ending into blocks.
+ *
+ * A block whose legal positions all have the same bit is stored as that bit; the illegal positions, which are never probed, do not count.
+ *
+ * @param material Material of the ending.
+ * @param wins Bits of the positions.
+ * @param blocks Filled with the entry of each block.
+ * @param raw Filled with the bits of the raw blocks, one after the other.
+ * @return Number of raw blocks.
+ */
+static uint32_t bitbase_compress(const struct BitbaseMaterial *material, const uint64_t *wins, uint32_t *blocks, uint64_t *raw) {
+  uint32_t blockCount = bitbase_positions(material) / BITBASE_BLOCK_POSITIONS;
+  uint32_t rawCount = 0;
+
+  for (uint32_t block = 0; block < blockCount; block++) {
+    const uint64_t *bits = &wins[block * BITBASE_BLOCK_WORDS];
+    bool zeros = false;
+    bool ones = false;
+    for (uint32_t i = 0; i < BITBASE_BLOCK_POSITIONS && !(zeros && ones); i++) {
+      uint32_t index = block * BITBASE_BLOCK_POSITIONS + i;
+      struct BitbasePosition pos;
+      bitbase_decode(material, index, &pos);
+      if (bitbase_legal(material, &pos)) {
+        if ((bits[i >> 6] >> (i & 63)) & 1) {
+          ones = true;
+        }
+        else {
+          zeros = true;
+        }
+      }
+    }
+
+    if (zeros && ones) {
+      memcpy(&raw[rawCount * BITBASE_BLOCK_WORDS], bits, BITBASE_BLOCK_WORDS * sizeof(uint64_t));
+      blocks[block] = (BITBASE_BLOCK_RAW << 30) | rawCount++;
+    }
+    else {
+      blocks[block] = (ones ? BITBASE_BLOCK_ONE : BITBASE_BLOCK_ZERO) << 30;
+    }
+  }
+  return rawCount;
+}
+
+/**
+ * @brief Writes the compressed bitbases of every ending to a file.
+ *
+ * The header is followed by the blocks of every table, then by the raw bits of every table, 8-byte aligned.
+ *
+ * @param path Path of the file.
+ * @param blocks Entries of the blocks of each ending.
+ * @param raw Bits of the raw blocks of each ending.
+ * @param rawCount Number of raw blocks of each ending.
+ * @return 0 upon success, 1 if the file could not be written.
+ */
+static int bitbase_write(const char *path, uint32_t *const blocks[BITBASE_ENDINGS], uint64_t *const raw[BITBASE_ENDINGS],
+                         const uint32_t rawCount[BITBASE_ENDINGS]) {
+  uint32_t blockCount[BITBASE_ENDINGS];
+  uint32_t blocksOffset[BITBASE_ENDINGS];
+  uint32_t bitsOffset[BITBASE_ENDINGS];
+  uint32_t offset = BITBASE_HEADER_SIZE + BITBASE_ENDINGS * BITBASE_TABLE_SIZE;
+  for (int e = 0; e < BITBASE_ENDINGS; e++) {
+    blockCount[e] = bitbase_positions(&bitbase_materials[e]) / BITBASE_BLOCK_POSITIONS;
+    blocksOffset[e] = offset;
+    offset += blockCount[e] * sizeof(uint32_t);
+  }
+  uint32_t padding = (8 - offset % 8) % 8;
+  offset += padding;
+  for (int e = 0; e < BITBASE_ENDINGS; e++) {
+    bitsOffset[e] = offset;
+    offset += rawCount[e] * BITBASE_BLOCK_WORDS * sizeof(uint64_t);
+  }
+
+  FILE *stream = fopen(path, "wb");
+  if (stream == NULL) {
+    return 1;
+  }
+  int failed = fwrite(bitbase_magic, sizeof(bitbase_magic), 1, stream) != 1;
+  failed |= write_u32(stream, BITBASE_VERSION);
+  failed |= write_u32(stream, BITBASE_ENDINGS);
+  for (int e = 0; e < BITBASE_ENDINGS; e++) {
+    char name[BITBASE_NAME_LENGTH] = {0};
+    strcpy(name, bitbase_materials[e].name);
+    failed |= fwrite(name, sizeof(name), 1, stream) != 1;
+    failed |= write_u32(stream, blockCount[e]);
+    failed |= write_u32(stream, blocksOffset[e]);
+    failed |= write_u32(stream, bitsOffset[e]);
+    failed |= write_u32(stream, rawCount[e]);
+  }
+  for (int e = 0; e < BITBASE_ENDINGS; e++) {
+    failed |= fwrite(blocks[e], sizeof(uint32_t), blockCount[e], stream) != blockCount[e];
+  }
+  for (uint32_t i = 0; i < padding; i++) {
+    failed |= fputc(0, stream) == EOF;
+  }
+  for (int e = 0; e < BITBASE_ENDINGS; e++) {
+    size_t words = (size_t) rawCount[e] * BITBASE_BLOCK_WORDS;
+    failed |= fwrite(raw[e], sizeof(uint64_t), words, stream) != words;
+  }
+  failed |= fclose(stream) != 0;
+
+  if (failed) {
+    return 1;
+  }
+  printf("%s: %u bytes\n", path, offset);
+  return 0;
+}
+
+/**
+ * @brief Generates the bitbases of every ending and writes them to a file.
+ *
+ * KQK and KRK are generated first, as the promotions of KPK lead into them.
+ *
+ * @param path Path of the file to write.
+ * @param threads Number of threads to generate with; clamped to 1..BITBASE_MAX_THREADS, and 1 outside the Linux host build.
+ * @return 0 upon success, 1 if memory could not be allocated or the file could not be written.
+ */
+int bitbase_generate(const char *path, int threads) {
+  uint32_t *blocks[BITBASE_ENDINGS] = {NULL};
+  uint64_t *raw[BITBASE_ENDINGS] = {NULL};
+  uint64_t *wins[BITBASE_ENDINGS] = {NULL};
+  uint32_t rawCount[BITBASE_ENDINGS];
+  bool failed = false;
+
+#ifndef __linux__
+  threads = 1;
+#endif
+  if (threads < 1) {
+    threads = 1;
+  }
+  if (threads > BITBASE_MAX_THREADS) {
+    threads = BITBASE_MAX_THREADS;
+  }
+
+  for (int e = 0; e < BITBASE_ENDINGS && !failed; e++) {
+    struct BitbaseGenerator gen;
+    gen.material = &bitbase_materials[e];
+    gen.positions = bitbase_positions(gen.material);
+    gen.promotions[0] = wins[BITBASE_KQK];
+    gen.promotions[1] = wins[BITBASE_KRK];
+    gen.threads = threads;
+    gen.wins = wins[e] = calloc(gen.positions / 64, sizeof(uint64_t));
+    blocks[e] = malloc(gen.positions / BITBASE_BLOCK_POSITIONS * sizeof(uint32_t));
+    raw[e] = malloc(gen.positions / 64 * sizeof(uint64_t));
+    failed = gen.wins == NULL || blocks[e] == NULL || raw[e] == NULL || bitbase_solve(&gen) != 0;
+    if (!failed) {
+      rawCount[e] = bitbase_compress(gen.material, gen.wins, blocks[e], raw[e]);
+    }
+  }
+  if (failed) {
+    printf("bitbase: out of memory\n");
+  }
+  else if (bitbase_write(path, blocks, raw, rawCount) != 0) {
+    printf("bitbase: could not write %s\n", path);
+    failed = true;
+  }
+
+  for (int e = 0; e < BITBASE_ENDINGS; e++) {
+    free(blocks[e]);
+    free(raw[e]);
+    free(wins[e]);
+  }
+  return failed ? 1 : 0;
+}
+
+/**
+ * @brief Reads a 32-bit number from the loaded file.
+ *
+ * @param offset Offset of the number.
+ * @return The number.
+ */
+static uint32_t read_u32(size_t offset) {
+  uint32_t value;
+  memcpy(&value, bitbases.file.data + offset, sizeof(value));
+  return value;
+}
+
+/**
+ * @brief Finds the tables of the endings in the header of the loaded file.
+ *
+ * @return 0 upon success, 1 if the header is not the one of a bitbase file or a table lies outside the file.
+ */
+static int bitbase_parse() {
+  if (bitbases.file.bytes < BITBASE_HEADER_SIZE || memcmp(bitbases.file.data, bitbase_magic, sizeof(bitbase_magic)) != 0 ||
+      read_u32(4) != BITBASE_VERSION) {
+    return 1;
+  }
+  uint32_t tableCount = read_u32(8);
+  if (bitbases.file.bytes < BITBASE_HEADER_SIZE + (uint64_t) tableCount * BITBASE_TABLE_SIZE) {
+    return 1;
+  }
+
+  for (uint32_t t = 0; t < tableCount; t++) {
+    size_t entry = BITBASE_HEADER_SIZE + t * BITBASE_TABLE_SIZE;
+    char name[BITBASE_NAME_LENGTH];
+    memcpy(name, bitbases.file.data + entry, sizeof(name));
+    name[BITBASE_NAME_LENGTH - 1] = '\0';
+    uint32_t blockCount = read_u32(entry + 8);
+    uint32_t blocksOffset = read_u32(entry + 12);
+    uint32_t bitsOffset = read_u32(entry + 16);
+    uint32_t rawCount = read_u32(entry + 20);
+
+    for (int e = 0; e < BITBASE_ENDINGS; e++) {
+      if (strcmp(name, bitbase_materials[e].name) != 0) {
+        continue;
+      }
+      if (blockCount != bitbase_positions(&bitbase_materials[e]) / BITBASE_BLOCK_POSITIONS || blocksOffset % 4 != 0 || bitsOffset % 8 != 0 ||
+          blocksOffset + (uint64_t) blockCount * sizeof(uint32_t) > bitbases.file.bytes ||
+          bitsOffset + (uint64_t) rawCount * BITBASE_BLOCK_WORDS * sizeof(uint64_t) > bitbases.file.bytes) {
+        return 1;
+      }
+      struct BitbaseTable *table = &bitbases.tables[e];
+      table->blocks = (const uint32_t *) (bitbases.file.data + blocksOffset);
+      table->bits = (const uint64_t *) (bitbases.file.data + bitsOffset);
+      table->blockCount = blockCount;
+      for (uint32_t b = 0; b < blockCount; b++) {
+        if ((table->blocks[b] >> 30) == BITBASE_BLOCK_RAW && (table->blocks[b] & 0x3FFFFFFF) >= rawCount) {
+          return 1;
+        }
+      }
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief Loads a bitbase file, replacing the one loaded before.
+ *
+ * @param path Path of the file.
+ * @return 0 upon success, 1 if the file cannot be read or is not a bitbase file.
+ */
+int bitbase_load(const char *path) {
+  bitbase_free();
+  if (mapped_file_open(&bitbases.file, path) != 0) {
+    return 1;
+  }
+  if (bitbase_parse() != 0) {
+    printf("%s is not a bitbase file\n", path);
+    bitbase_free();
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Unloads the bitbase file.
+ */
+void bitbase_free() {
+  mapped_file_close(&bitbases.file);
+  memset(&bitbases, 0, sizeof(bitbases));
+}
+
+/**
+ * @brief Reads the bit of a position from a table.
+ *
+ * @param table Pointer to the table.
+ * @param index Index of the position.
+ * @return Whether the strong side wins the position.
+ */
+static bool bitbase_bit(const struct BitbaseTable *table, uint32_t index) {
+  uint32_t block = table->blocks[index / BITBASE_BLOCK_POSITIONS];
+  switch (block >> 30) {
+    case BITBASE_BLOCK_ONE:
+      return true;
+    case BITBASE_BLOCK_RAW: {
+      uint32_t bit = index % BITBASE_BLOCK_POSITIONS;
+      return (table->bits[(block & 0x3FFFFFFF) * BITBASE_BLOCK_WORDS + bit / 64] >> (bit % 64)) & 1;
+    }
+    default:
+      return false;
+  }
+}
+
+/**
+ * @brief Looks up the outcome of the current position of a game in the bitbases.
+ *
+ * The bitbases know nothing of the fifty-move rule; none of their wins takes long enough for it to matter.
+ *
+ * @param game Pointer to the game.
+ * @return The outcome for the side to move, or TB_UNKNOWN if the position is not one of a loaded ending.
+ */
+enum TBWdl bitbase_probe(const struct Game *game) {
+  const struct Bitboard *bb = &game->board.bitboard;
+  if (bitbases.file.data == NULL) {
+    return TB_UNKNOWN;
+  }
+
+  int weak = bb->colors[BLACK] == bb->pieces[BLACK][KING] ? BLACK : WHITE;
+  int strong = !weak;
+  if (bb->colors[weak] != bb->pieces[weak][KING]) {
+    return TB_UNKNOWN;
+  }
+
+  for (int e = 0; e < BITBASE_ENDINGS; e++) {
+    const struct BitbaseMaterial *material = &bitbase_materials[e];
+    const struct BitbaseTable *table = &bitbases.tables[e];
+    if (table->blocks == NULL || bitboard_count(bb->colors[strong]) != 1 + material->count) {
+      continue;
+    }
+    bool matches = true;
+    for (int i = 0; i < material->count; i++) {
+      matches = matches && bb->pieces[strong][material->types[i]] != 0;
+    }
+    if (!matches) {
+      continue;
+    }
+
+    // black's pieces are looked up as white's with the ranks mirrored
+    int flip = strong == WHITE ? 0 : 56;
+    struct BitbasePosition pos;
+    pos.weakToMove = (bb->isWhiteTurn ? WHITE : BLACK) == weak;
+    pos.strongKing = bitboard_lsb(bb->pieces[strong][KING]) ^ flip;
+    pos.weakKing = bitboard_lsb(bb->pieces[weak][KING]) ^ flip;
+    for (int i = 0; i < material->count; i++) {
+      pos.squares[i] = bitboard_lsb(bb->pieces[strong][material->types[i]]) ^ flip;
+    }
+
+    bool won = bitbase_bit(table, bitbase_index(material, &pos));
+    if (!won) {
+      return TB_DRAW;
+    }
+    return pos.weakToMove ? TB_LOSS : TB_WIN;
+  }
+  return TB_UNKNOWN;
+}
+
+/**
+ * @brief Runs the generator from command line arguments: "bitbase <file> [threads]".
+ *
+ * The number of threads defaults to the number of processors of the Linux host.
+ *
+ * @param argc Number of arguments, the first being "bitbase".
+ * @param argv The arguments.
+ * @return 0 upon success, 1 otherwise.
+ */
+int bitbase_command(int argc, char *argv[]) {
+  if (argc < 2) {
+    printf("usage: bitbase <file> [threads]\n");
+    return 1;
+  }
+  int threads = argc > 2 ? atoi(argv[2]) : 1;
+#ifdef __linux__
+  if (argc <= 2) {
+    threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+  }
+#endif
+
+  if (init_bitboard_tables() != 0) {
+    return 1;
+  }
+  if (bitbase_generate(argv[1], threads) != 0) {
+    return 1;
+  }
+
+  uint64_t start = timing_now_us();
+  if (bitbase_load(argv[1]) != 0) {
+    return 1;
+  }
+  printf("loaded in %llu us\n", (unsigned long long) (timing_now_us() - start));
+  bitbase_free();
+  return 0;
+}
@@ -0,0 +1,98 @@
+/**
+ * @file bitbase.h
+ * @brief Header file containing the bitbases of the most common endings, and their generator.
+ *
+ * A bitbase holds one bit per position of an ending of a king and one or two pieces against a
+ * lone king (KPK, KRK, KQK and KBNK): whether the side with the pieces wins. It is generated
+ * by retrograde analysis from the mates, with the move rules of the bitboards, and written to
+ * one file of compressed blocks that is used in place: loading it at startup only maps it
+ * and checks its header, and a probe reads a single bit of it.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../../../utils/mapped_file.h"
+#include "../game.h"
+#include "tablebase.h"
+
+/** @brief Number of positions of a block of a bitbase file; blocks whose legal positions all have the same bit are stored as that bit alone. */
+#define BITBASE_BLOCK_POSITIONS 4096
+
+/** @brief Most threads the generator runs on. */
+#define BITBASE_MAX_THREADS 64
+
+/**
+ * @brief Enum representing the endings with a bitbase.
+ */
+enum BitbaseEnding {
+  BITBASE_KQK,  /**< king and queen against king */
+  BITBASE_KRK,  /**< king and rook against king */
+  BITBASE_KPK,  /**< king and pawn against king */
+  BITBASE_KBNK, /**< king, bishop and knight against king */
+  BITBASE_ENDINGS /**< number of endings */
+};
+
+/**
+ * @brief Structure representing the bitbase of one ending, as found in the file.
+ */
+struct BitbaseTable {
+  const uint32_t *blocks; /**< per block: its kind in the two high bits, and for raw blocks the first word of its bits */
+  const uint64_t *bits;   /**< bits of the raw blocks */
+  uint32_t blockCount;    /**< number of blocks */
+};
+
+/**
+ * @brief Structure representing the loaded bitbase file.
+ */
+struct Bitbases {
+  struct MappedFile file;                       /**< the file, data NULL if none is loaded */
+  struct BitbaseTable tables[BITBASE_ENDINGS];  /**< table of each ending, blocks NULL if the file has none */
+};
+
+/**
+ * @brief Bitbases of the program.
+ */
+extern struct Bitbases bitbases;
+
+/**
+ * @brief Generates the bitbases of every ending and writes them to a file.
+ *
+ * @param path Path of the file to write.
+ * @param threads Number of threads to generate with; clamped to 1..BITBASE_MAX_THREADS, and 1 outside the Linux host build.
+ * @return 0 upon success, 1 if memory could not be allocated or the file could not be written.
+ */
+int bitbase_generate(const char *path, int threads);
+
+/**
+ * @brief Loads a bitbase file, replacing the one loaded before.
+ *
+ * @param path Path of the file.
+ * @return 0 upon success, 1 if the file cannot be read or is not a bitbase file.
+ */
+int bitbase_load(const char *path);
+
+/**
+ * @brief Unloads the bitbase file.
+ */
+void bitbase_free();
+
+/**
+ * @brief Looks up the outcome of the current position of a game in the bitbases.
+ *
+ * @param game Pointer to the game.
+ * @return The outcome for the side to move, or TB_UNKNOWN if the position is not one of a loaded ending.
+ */
+enum TBWdl bitbase_probe(const struct Game *game);
+
+/**
+ * @brief Runs the generator from command line arguments: "bitbase <file> [threads]".
+ *
+ * @param argc Number of arguments, the first being "bitbase".
+ * @param argv The arguments.
+ * @return 0 upon success, 1 otherwise.
+ */
+int bitbase_command(int argc, char *argv[]);
@@ -0,0 +1,84 @@
+/**
+ * @file tablebase.c
+ * @brief Implementation of the probing of the endgame knowledge of the program.
+ *
+ * A probe first settles what needs no table: positions with castling rights or too many pieces
+ * are unknown, and positions where neither side can mate are draws. The others are looked up in
+ * the bitbases, which only read the loaded file, so the threads of a parallel search probe at
+ * the same time without any lock.
+ */
+
+#include <string.h>
+
+#include "tablebase.h"
+#include "bitbase.h"
+
+struct Tablebases tablebases;
+
+/** @brief Bits of a cache entry that hold the outcome. */
+#define TB_CACHE_WDL_MASK 0x3ULL
+
+/**
+ * @brief Loads the bitbases and forgets every cached result.
+ *
+ * @param path Path of the bitbase file, or NULL for none.
+ * @return 0 upon success, 1 if the file cannot be loaded, in which case only the draws by insufficient material are known.
+ */
+int tb_init(const char *path) {
+  tb_free();
+  memset(tablebases.cache, 0, sizeof(tablebases.cache));
+  tablebases.probes = 0;
+  tablebases.hits = 0;
+  if (path == NULL) {
+    return 0;
+  }
+  return bitbase_load(path);
+}
+
+/**
+ * @brief Unloads the bitbases.
+ */
+void tb_free() {
+  bitbase_free();
+}
+
+/**
+ * @brief Looks up the outcome of a position, without the cache.
+ *
+ * @param game Pointer to the game.
+ * @return The outcome for the side to move, or TB_UNKNOWN.
+ */
+static enum TBWdl tb_lookup(struct Game *game) {
+  if (is_draw(game)) {
+    return TB_DRAW;
+  }
+  return bitbase_probe(game);
+}
+
+/**
+ * @brief Looks up the outcome of the current position of a game.
+ *
+ * The bitbases know nothing of castling, so positions with castling rights are never probed.
+ *
+ * @param game Pointer to the game.
+ * @return The outcome for the side to move, or TB_UNKNOWN.
+ */
+enum TBWdl tb_probe_wdl(struct Game *game) {
+  const struct Bitboard *bb = &game->board.bitboard;
+  if (bitboard_count(bb->occupied) > TB_MAX_PIECES || bb->castling != 0) {
+    return TB_UNKNOWN;
+  }
+
+  __atomic_fetch_add(&tablebases.probes, 1, __ATOMIC_RELAXED);
+  // the two low bits of the hash are part of the index, so the outcome can take their place
+  uint64_t *entry = &tablebases.cache[game->hash & (TB_CACHE_SIZE - 1)];
+  uint64_t data = __atomic_load_n(entry, __ATOMIC_RELAXED);
+  if (data != 0 && (data & ~TB_CACHE_WDL_MASK) == (game->hash & ~TB_CACHE_WDL_MASK)) {
+    __atomic_fetch_add(&tablebases.hits, 1, __ATOMIC_RELAXED);
+    return (enum TBWdl) (data & TB_CACHE_WDL_MASK);
+  }
+
+  enum TBWdl wdl = tb_lookup(game);
+  __atomic_store_n(entry, (game->hash & ~TB_CACHE_WDL_MASK) | wdl, __ATOMIC_RELAXED);
+  return wdl;
+}
@@ -0,0 +1,72 @@
+/**
+ * @file tablebase.h
+ * @brief Header file containing the probing of the endgame knowledge of the program.
+ *
+ * With few pieces left the outcome of a position under perfect play can be looked up instead
+ * of searched. A probe answers win, draw or loss for the side to move, or unknown when nothing
+ * covers the material. Positions where neither side can mate are draws, and the endings of a
+ * king and one or two pieces against a lone king are read from the bitbases (see bitbase.h).
+ * The results of recent probes are kept in a small cache that the threads of a parallel search
+ * share without locks, a cache entry being a single word.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../game.h"
+
+/** @brief Most pieces, kings included, of a position that is probed; the largest ending of the bitbases has four. */
+#define TB_MAX_PIECES 4
+
+/** @brief Number of entries of the probe cache; a power of two. */
+#define TB_CACHE_SIZE 4096
+
+/**
+ * @brief Enum representing the outcome of a position for the side to move.
+ *
+ * The fifty-move rule is left out: none of the wins that are known takes long enough for it to matter.
+ */
+enum TBWdl {
+  TB_UNKNOWN, /**< nothing covers the position */
+  TB_LOSS,    /**< the side to move loses */
+  TB_DRAW,    /**< the position is drawn */
+  TB_WIN      /**< the side to move wins */
+};
+
+/**
+ * @brief Structure representing the state of the probing.
+ */
+struct Tablebases {
+  uint64_t cache[TB_CACHE_SIZE]; /**< recent results: the hash of the position with the outcome in its two low bits, 0 if empty */
+  uint64_t probes;               /**< probes since the initialization */
+  uint64_t hits;                 /**< probes answered by the cache */
+};
+
+/**
+ * @brief Tablebases of the program, shared by the search and the game-result logic.
+ */
+extern struct Tablebases tablebases;
+
+/**
+ * @brief Loads the bitbases and forgets every cached result.
+ *
+ * @param path Path of the bitbase file, or NULL for none.
+ * @return 0 upon success, 1 if the file cannot be loaded, in which case only the draws by insufficient material are known.
+ */
+int tb_init(const char *path);
+
+/**
+ * @brief Unloads the bitbases.
+ */
+void tb_free();
+
+/**
+ * @brief Looks up the outcome of the current position of a game.
+ *
+ * @param game Pointer to the game.
+ * @return The outcome for the side to move, or TB_UNKNOWN.
+ */
+enum TBWdl tb_probe_wdl(struct Game *game);
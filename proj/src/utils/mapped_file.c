@@ -0,0 +1,94 @@
+/**
+ * @file mapped_file.c
+ * @brief Implementation of the read-only files the program uses in place.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "mapped_file.h"
+
+/**
+ * @brief Opens a file and makes its contents available.
+ *
+ * Both users of these files, the book and the bitbases, read them at scattered places, so the kernel is told not to read ahead.
+ *
+ * @param file Pointer to the file to be set up; its data is NULL on failure.
+ * @param path Path of the file.
+ * @return 0 upon success, 1 if the file cannot be read or is empty.
+ */
+int mapped_file_open(struct MappedFile *file, const char *path) {
+  file->data = NULL;
+  file->bytes = 0;
+  file->mapped = false;
+
+#ifdef __linux__
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return 1;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    return 1;
+  }
+  void *memory = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED) {
+    return 1;
+  }
+  // read-ahead would only bring in pages no lookup wants
+  madvise(memory, st.st_size, MADV_RANDOM);
+  file->data = memory;
+  file->bytes = st.st_size;
+  file->mapped = true;
+  return 0;
+#else
+  FILE *stream = fopen(path, "rb");
+  if (stream == NULL) {
+    return 1;
+  }
+  long size = -1;
+  if (fseek(stream, 0, SEEK_END) == 0) {
+    size = ftell(stream);
+  }
+  rewind(stream);
+  uint8_t *memory = size > 0 ? malloc(size) : NULL;
+  if (memory == NULL || fread(memory, 1, size, stream) != (size_t) size) {
+    free(memory);
+    fclose(stream);
+    return 1;
+  }
+  fclose(stream);
+  file->data = memory;
+  file->bytes = size;
+  return 0;
+#endif
+}
+
+/**
+ * @brief Closes a file; closing one that is not open does nothing.
+ *
+ * @param file Pointer to the file.
+ */
+void mapped_file_close(struct MappedFile *file) {
+#ifdef __linux__
+  if (file->mapped) {
+    munmap((void *) file->data, file->bytes);
+  }
+  else
+#endif
+  {
+    free((void *) file->data);
+  }
+  file->data = NULL;
+  file->bytes = 0;
+  file->mapped = false;
+}
@@ -0,0 +1,40 @@
+/**
+ * @file mapped_file.h
+ * @brief Header file containing the read-only files the program uses in place: the opening book and the bitbases.
+ *
+ * On the Linux host build a file is mapped read-only, so only the pages that are touched are
+ * ever read from disk and opening a large file costs nothing; under Minix it is read into one
+ * heap block when it is opened. Either way its contents are one block of memory until it is
+ * closed.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Structure representing an opened file.
+ */
+struct MappedFile {
+  const uint8_t *data; /**< contents of the file, or NULL if none is open */
+  size_t bytes;        /**< size of the file */
+  bool mapped;         /**< whether the contents are mapped from the file rather than read into the heap */
+};
+
+/**
+ * @brief Opens a file and makes its contents available.
+ *
+ * @param file Pointer to the file to be set up; its data is NULL on failure.
+ * @param path Path of the file.
+ * @return 0 upon success, 1 if the file cannot be read or is empty.
+ */
+int mapped_file_open(struct MappedFile *file, const char *path);
+
+/**
+ * @brief Closes a file; closing one that is not open does nothing.
+ *
+ * @param file Pointer to the file.
+ */
+void mapped_file_close(struct MappedFile *file);
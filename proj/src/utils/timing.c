@@ -0,0 +1,34 @@
+/**
+ * @file timing.c
+ * @brief Implementation of the wall-clock helpers used to time benchmarks.
+ */
+
+#include <stddef.h>
+#include <sys/time.h>
+
+#include "timing.h"
+
+/**
+ * @brief Returns the current wall-clock time.
+ *
+ * This function reads the system time of day, which is precise to the microsecond, unlike the 60 Hz timer interrupts.
+ *
+ * @return Microseconds since the epoch.
+ */
+uint64_t timing_now_us(void) {
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return (uint64_t) tv.tv_sec * 1000000 + (uint64_t) tv.tv_usec;
+}
+
+/**
+ * @brief Computes a rate per second from a count and an elapsed time.
+ *
+ * @param count Number of events (e.g. nodes).
+ * @param elapsedUs Elapsed time in microseconds.
+ * @return Events per second, or 0 if no time elapsed.
+ */
+uint64_t timing_per_second(uint64_t count, uint64_t elapsedUs) {
+  return elapsedUs ? count * 1000000 / elapsedUs : 0;
+}
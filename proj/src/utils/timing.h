@@ -0,0 +1,24 @@
+/**
+ * @file timing.h
+ * @brief Header file containing the wall-clock helpers used to time benchmarks.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @brief Returns the current wall-clock time.
+ *
+ * @return Microseconds since the epoch.
+ */
+uint64_t timing_now_us(void);
+
+/**
+ * @brief Computes a rate per second from a count and an elapsed time.
+ *
+ * @param count Number of events (e.g. nodes).
+ * @param elapsedUs Elapsed time in microseconds.
+ * @return Events per second, or 0 if no time elapsed.
+ */
+uint64_t timing_per_second(uint64_t count, uint64_t elapsedUs);